@@ -0,0 +1,139 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg capture_store
+*/
+/**
+* Store of all transfers: columns of record fields and arena of payload bytes.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 18.10.2026 00:40:00<br>
+* @pkgdoc capture_store
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "capture_store.h"
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+/*----------------------------------------------------------------------------*/
+CaptureStore::CaptureStore() {
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Place for payload: rest of last page, new page or page of its own.
+ * Returns null for empty payload.
+ */
+uchar *CaptureStore::reserve(size_t size) {
+  if(!size) {
+    return nullptr;
+  }
+  if(m_pages.empty() || m_pages.back().size - m_used < size) {
+    size_t pageSize = size > static_cast<size_t>(PAGE_BYTES) ? size : static_cast<size_t>(PAGE_BYTES);
+    m_pages.push_back(Page{std::unique_ptr<uchar[]>(new uchar[pageSize]), pageSize, m_count});
+    m_used = 0;
+  }
+  uchar *p = m_pages.back().data.get() + m_used;
+  m_used += size;
+  return p;
+}
+/*----------------------------------------------------------------------------*/
+qint64 CaptureStore::append(Direction direction, const void *data, size_t size, int status, int endpoint, qint64 time) {
+  if(!time) {
+    time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+  }
+  size_t pages = m_pages.size();
+  uchar *p = reserve(size);
+  if(p) {
+    memcpy(p, data, size);
+  }
+  qint64 index = m_count;
+  m_time.append(time, index);
+  m_length.append(static_cast<quint32>(size), index);
+  m_page.append(static_cast<quint32>(p ? m_firstPage + m_pages.size() - 1 : 0), index);
+  m_offset.append(static_cast<quint32>(p ? m_used - size : 0), index);
+  m_direction.append(static_cast<quint8>(direction), index);
+  m_status.append(static_cast<quint8>(status), index);
+  m_endpoint.append(static_cast<quint8>(endpoint), index);
+  m_count++;
+  m_bytes += size;
+  if(m_pages.size() != pages || !(index & (CaptureColumn<qint64>::BLOCK - 1))) {
+    fit();
+  }
+  return index;
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Pages before the one holding record index are freed, current page is
+ * kept for appending.
+ */
+void CaptureStore::release(qint64 index) {
+  m_first = std::max(m_first, std::min(index, m_count));
+  while(m_pages.size() > 1 && m_pages[1].first <= m_first) {
+    m_pages.pop_front();
+    m_firstPage++;
+  }
+  m_time.release(m_first);
+  m_length.release(m_first);
+  m_page.release(m_first);
+  m_offset.release(m_first);
+  m_direction.release(m_first);
+  m_status.release(m_first);
+  m_endpoint.release(m_first);
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Releases oldest page while memory exceeds limit, oldest blocks of columns
+ * if only current page is left. Called when page or block is allocated.
+ */
+void CaptureStore::fit() {
+  while(memory() > m_limit && m_first < m_count) {
+    if(m_pages.size() > 1) {
+      release(m_pages[1].first);
+    } else {
+      release(std::min(m_count, (m_first | (CaptureColumn<qint64>::BLOCK - 1)) + 1));
+    }
+  }
+}
+/*----------------------------------------------------------------------------*/
+void CaptureStore::setLimit(qint64 limit) {
+  m_limit = limit;
+  fit();
+}
+/*----------------------------------------------------------------------------*/
+void CaptureStore::clear() {
+  m_time.clear();
+  m_length.clear();
+  m_page.clear();
+  m_offset.clear();
+  m_direction.clear();
+  m_status.clear();
+  m_endpoint.clear();
+  m_pages.clear();
+  m_firstPage = 0;
+  m_used = 0;
+  m_first = 0;
+  m_count = 0;
+  m_bytes = 0;
+}
+/*----------------------------------------------------------------------------*/
+qint64 CaptureStore::memory() const {
+  size_t total = m_time.memory() + m_length.memory() + m_page.memory() + m_offset.memory()
+      + m_direction.memory() + m_status.memory() + m_endpoint.memory();
+  for(const Page& page : m_pages) {
+    total += page.size;
+  }
+  return static_cast<qint64>(total);
+}
+/*----------------------------------------------------------------------------*/
+QByteArray CaptureStore::copy(qint64 first, qint64 count, qint64 size) const {
+  QByteArray result;
+  read(first, count, [&](const uchar *p, size_t length) {
+    if(size >= 0 && result.size() + static_cast<qint64>(length) > size) {
+      length = static_cast<size_t>(size - result.size());
+    }
+    result.append(reinterpret_cast<const char *>(p), static_cast<int>(length));
+  });
+  return result;
+}
+/*----------------------------------------------------------------------------*/
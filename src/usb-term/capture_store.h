@@ -0,0 +1,155 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg capture_store
+*/
+/**
+* Store of all transfers: columns of record fields and arena of payload bytes.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 18.10.2026 00:40:00<br>
+* @pkgdoc capture_store
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef CAPTURE_STORE_H_1792284000
+#define CAPTURE_STORE_H_1792284000
+/*----------------------------------------------------------------------------*/
+#include <QtGlobal>
+#include <QByteArray>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <stddef.h>
+/*----------------------------------------------------------------------------*/
+/**
+ * Column of fixed size values in blocks of BLOCK entries.
+ * Growing never moves stored values, so pointers to them stay valid.
+ */
+template<class T>
+class CaptureColumn {
+public:
+  enum {
+    BLOCK_BITS = 16,
+    BLOCK = 1 << BLOCK_BITS
+  };
+  void append(T value, qint64 index) {
+    if(!(index & (BLOCK - 1)) && static_cast<size_t>(index >> BLOCK_BITS) == m_blocks.size()) {
+      m_blocks.emplace_back(new T[BLOCK]);
+    }
+    m_blocks[static_cast<size_t>(index >> BLOCK_BITS)][index & (BLOCK - 1)] = value;
+  }
+  T operator[](qint64 index) const {return m_blocks[static_cast<size_t>(index >> BLOCK_BITS)][index & (BLOCK - 1)];}
+  /**Frees blocks with all indexes below index*/
+  void release(qint64 index) {
+    for(size_t end = static_cast<size_t>(index >> BLOCK_BITS); m_released < end; m_released++) {
+      m_blocks[m_released].reset();
+    }
+  }
+  void clear() {
+    m_blocks.clear();
+    m_released = 0;
+  }
+  size_t memory() const {return (m_blocks.size() - m_released) * BLOCK * sizeof(T);}
+private:
+  std::vector<std::unique_ptr<T[]>> m_blocks;
+  size_t m_released = 0;  //Leading blocks freed
+};
+/*----------------------------------------------------------------------------*/
+/**
+ * Append only store of transfers. Record i has fields in parallel columns,
+ * payload is contiguous in arena page: it starts new page if it does not fit
+ * in current one, payloads over PAGE_BYTES get page of their own.
+ * Nothing is allocated per record, only blocks of columns and pages.
+ *
+ * Memory is bounded by limit: oldest records are released by whole pages
+ * and blocks, indexes of kept records do not change. Records from first()
+ * to count() - 1 can be read.
+ *
+ * Readers get pointers into the arena, valid until the record is released.
+ * Store is not thread safe: it is filled and read by GUI thread.
+ */
+class CaptureStore {
+public:
+  enum Direction {
+    Received,
+    Sent
+  };
+  enum {
+    PAGE_BYTES = 4 << 20,
+    DEFAULT_LIMIT = 256 << 20   //Bytes of memory
+  };
+  CaptureStore();
+  /**
+   * Adds record, returns its index. Time is microseconds since epoch,
+   * current time if 0. Status is transport status, 0 is success.
+   * Oldest records are released if memory exceeds limit.
+   */
+  qint64 append(Direction direction, const void *data, size_t size, int status = 0, int endpoint = 0, qint64 time = 0);
+  /**Records before index are not needed, their whole pages and blocks are freed*/
+  void release(qint64 index);
+  void clear();
+
+  /**Oldest record not released*/
+  qint64 first() const {return m_first;}
+  /**Records appended since clear(), index of next record*/
+  qint64 count() const {return m_count;}
+  /**Payload bytes of all records appended since clear()*/
+  qint64 bytes() const {return m_bytes;}
+  /**Columns and arena, bytes allocated*/
+  qint64 memory() const;
+  qint64 limit() const {return m_limit;}
+  /**Bytes of memory kept, at least current page and block of columns stay*/
+  void setLimit(qint64 limit);
+
+  qint64 time(qint64 index) const {return m_time[index];}
+  Direction direction(qint64 index) const {return static_cast<Direction>(m_direction[index]);}
+  int status(qint64 index) const {return static_cast<qint8>(m_status[index]);}
+  int endpoint(qint64 index) const {return m_endpoint[index];}
+  size_t length(qint64 index) const {return m_length[index];}
+  /**Payload of record in arena*/
+  const uchar *data(qint64 index) const {
+    return length(index) ? m_pages[m_page[index] - m_firstPage].data.get() + m_offset[index] : nullptr;
+  }
+  /**Payload without copy, valid until the record is released*/
+  QByteArray payload(qint64 index) const {
+    return QByteArray::fromRawData(reinterpret_cast<const char *>(data(index)), static_cast<int>(length(index)));
+  }
+  /**
+   * Payloads of records from first to first + count - 1, in order,
+   * as f(const uchar *data, size_t size).
+   */
+  template<class F>
+  void read(qint64 first, qint64 count, F f) const {
+    for(qint64 i = first; i < first + count; i++) {
+      f(data(i), length(i));
+    }
+  }
+  /**Copy of up to size bytes of payloads of records from first to first + count - 1*/
+  QByteArray copy(qint64 first, qint64 count, qint64 size = -1) const;
+
+private:
+  CaptureColumn<qint64> m_time;
+  CaptureColumn<quint32> m_length;
+  CaptureColumn<quint32> m_page;
+  CaptureColumn<quint32> m_offset;
+  CaptureColumn<quint8> m_direction;
+  CaptureColumn<quint8> m_status;
+  CaptureColumn<quint8> m_endpoint;
+  struct Page {
+    std::unique_ptr<uchar[]> data;
+    size_t size;
+    qint64 first;      //Records before it are in older pages
+  };
+  std::deque<Page> m_pages;
+  quint32 m_firstPage = 0; //Number of m_pages.front(), m_page holds numbers
+  size_t m_used = 0;   //Bytes used in last page
+  qint64 m_first = 0;
+  qint64 m_count = 0;
+  qint64 m_bytes = 0;
+  qint64 m_limit = DEFAULT_LIMIT;
+  uchar *reserve(size_t size);
+  void fit();
+};
+/*----------------------------------------------------------------------------*/
+#endif /*CAPTURE_STORE_H_1792284000*/
@@ -0,0 +1,48 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg chardev_transport
+*/
+/**
+* Character device transport: kernel usblp (/dev/usb/lp*), FIFO, pty etc.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 13:05:12<br>
+* @pkgdoc chardev_transport
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "chardev_transport.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <glob.h>
+/*----------------------------------------------------------------------------*/
+bool CharDeviceTransport :: open(const std::string& path)
+{
+  close();
+  m_path = path;
+  return start();
+}
+/*----------------------------------------------------------------------------*/
+int CharDeviceTransport :: openDevice(int *fd)
+{
+  //O_RDWR also keeps FIFO from reporting POLLHUP when there is no other writer
+  *fd = ::open(m_path.c_str(), O_RDWR | O_NONBLOCK | O_NOCTTY | O_CLOEXEC);
+  return *fd < 0 ? errno : 0;
+}
+/*----------------------------------------------------------------------------*/
+std::vector<std::string> CharDeviceTransport :: printerDevices()
+{
+  std::vector<std::string> list;
+  glob_t g;
+  if(glob("/dev/usb/lp*", 0, nullptr, &g) == 0) {
+    for(size_t i = 0; i < g.gl_pathc; i++) {
+      list.push_back(g.gl_pathv[i]);
+    }
+    globfree(&g);
+  }
+  return list;
+}
+/*----------------------------------------------------------------------------*/
+
@@ -0,0 +1,38 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg chardev_transport
+*/
+/**
+* Character device transport: kernel usblp (/dev/usb/lp*), FIFO, pty etc.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 13:05:12<br>
+* @pkgdoc chardev_transport
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef CHARDEV_TRANSPORT_H_1792242312
+#define CHARDEV_TRANSPORT_H_1792242312
+/*----------------------------------------------------------------------------*/
+#include "poll_transport.h"
+/*----------------------------------------------------------------------------*/
+/**
+ * Transport over device file opened in non blocking mode.
+ * Kernel driver stays attached (no detach/claim as for libusb).
+ * If device disappears, it is reopened by path.
+ */
+class CharDeviceTransport : public PollTransport {
+protected:
+  std::string m_path;
+  int openDevice(int *fd) override;
+public:
+  bool open(const std::string& path);
+  ~CharDeviceTransport() {close();}
+  std::string name() const override {return m_path;}
+
+  /**List of kernel usblp devices*/
+  static std::vector<std::string> printerDevices();
+};
+/*----------------------------------------------------------------------------*/
+#endif /*CHARDEV_TRANSPORT_H_1792242312*/
@@ -0,0 +1,172 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg codepage
+*/
+/**
+* Single byte codepages of POS printers: CP437, CP866, CP1251.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 22:15:00<br>
+* @pkgdoc codepage
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "codepage.h"
+#include <string.h>
+/*----------------------------------------------------------------------------*/
+//Unicode of bytes 80..FF
+static const ushort UPPER[Codepage::COUNT][128] = {
+  {0}, //Utf8 has no table
+  {
+    0x00C7, 0x00FC, 0x00E9, 0x00E2, 0x00E4, 0x00E0, 0x00E5, 0x00E7,
+    0x00EA, 0x00EB, 0x00E8, 0x00EF, 0x00EE, 0x00EC, 0x00C4, 0x00C5,
+    0x00C9, 0x00E6, 0x00C6, 0x00F4, 0x00F6, 0x00F2, 0x00FB, 0x00F9,
+    0x00FF, 0x00D6, 0x00DC, 0x00A2, 0x00A3, 0x00A5, 0x20A7, 0x0192,
+    0x00E1, 0x00ED, 0x00F3, 0x00FA, 0x00F1, 0x00D1, 0x00AA, 0x00BA,
+    0x00BF, 0x2310, 0x00AC, 0x00BD, 0x00BC, 0x00A1, 0x00AB, 0x00BB,
+    0x2591, 0x2592, 0x2593, 0x2502, 0x2524, 0x2561, 0x2562, 0x2556,
+    0x2555, 0x2563, 0x2551, 0x2557, 0x255D, 0x255C, 0x255B, 0x2510,
+    0x2514, 0x2534, 0x252C, 0x251C, 0x2500, 0x253C, 0x255E, 0x255F,
+    0x255A, 0x2554, 0x2569, 0x2566, 0x2560, 0x2550, 0x256C, 0x2567,
+    0x2568, 0x2564, 0x2565, 0x2559, 0x2558, 0x2552, 0x2553, 0x256B,
+    0x256A, 0x2518, 0x250C, 0x2588, 0x2584, 0x258C, 0x2590, 0x2580,
+    0x03B1, 0x00DF, 0x0393, 0x03C0, 0x03A3, 0x03C3, 0x00B5, 0x03C4,
+    0x03A6, 0x0398, 0x03A9, 0x03B4, 0x221E, 0x03C6, 0x03B5, 0x2229,
+    0x2261, 0x00B1, 0x2265, 0x2264, 0x2320, 0x2321, 0x00F7, 0x2248,
+    0x00B0, 0x2219, 0x00B7, 0x221A, 0x207F, 0x00B2, 0x25A0, 0x00A0
+  },
+  {
+    0x0410, 0x0411, 0x0412, 0x0413, 0x0414, 0x0415, 0x0416, 0x0417,
+    0x0418, 0x0419, 0x041A, 0x041B, 0x041C, 0x041D, 0x041E, 0x041F,
+    0x0420, 0x0421, 0x0422, 0x0423, 0x0424, 0x0425, 0x0426, 0x0427,
+    0x0428, 0x0429, 0x042A, 0x042B, 0x042C, 0x042D, 0x042E, 0x042F,
+    0x0430, 0x0431, 0x0432, 0x0433, 0x0434, 0x0435, 0x0436, 0x0437,
+    0x0438, 0x0439, 0x043A, 0x043B, 0x043C, 0x043D, 0x043E, 0x043F,
+    0x2591, 0x2592, 0x2593, 0x2502, 0x2524, 0x2561, 0x2562, 0x2556,
+    0x2555, 0x2563, 0x2551, 0x2557, 0x255D, 0x255C, 0x255B, 0x2510,
+    0x2514, 0x2534, 0x252C, 0x251C, 0x2500, 0x253C, 0x255E, 0x255F,
+    0x255A, 0x2554, 0x2569, 0x2566, 0x2560, 0x2550, 0x256C, 0x2567,
+    0x2568, 0x2564, 0x2565, 0x2559, 0x2558, 0x2552, 0x2553, 0x256B,
+    0x256A, 0x2518, 0x250C, 0x2588, 0x2584, 0x258C, 0x2590, 0x2580,
+    0x0440, 0x0441, 0x0442, 0x0443, 0x0444, 0x0445, 0x0446, 0x0447,
+    0x0448, 0x0449, 0x044A, 0x044B, 0x044C, 0x044D, 0x044E, 0x044F,
+    0x0401, 0x0451, 0x0404, 0x0454, 0x0407, 0x0457, 0x040E, 0x045E,
+    0x00B0, 0x2219, 0x00B7, 0x221A, 0x2116, 0x00A4, 0x25A0, 0x00A0
+  },
+  {
+    0x0402, 0x0403, 0x201A, 0x0453, 0x201E, 0x2026, 0x2020, 0x2021,
+    0x20AC, 0x2030, 0x0409, 0x2039, 0x040A, 0x040C, 0x040B, 0x040F,
+    0x0452, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+    0xFFFD, 0x2122, 0x0459, 0x203A, 0x045A, 0x045C, 0x045B, 0x045F,
+    0x00A0, 0x040E, 0x045E, 0x0408, 0x00A4, 0x0490, 0x00A6, 0x00A7,
+    0x0401, 0x00A9, 0x0404, 0x00AB, 0x00AC, 0x00AD, 0x00AE, 0x0407,
+    0x00B0, 0x00B1, 0x0406, 0x0456, 0x0491, 0x00B5, 0x00B6, 0x00B7,
+    0x0451, 0x2116, 0x0454, 0x00BB, 0x0458, 0x0405, 0x0455, 0x0457,
+    0x0410, 0x0411, 0x0412, 0x0413, 0x0414, 0x0415, 0x0416, 0x0417,
+    0x0418, 0x0419, 0x041A, 0x041B, 0x041C, 0x041D, 0x041E, 0x041F,
+    0x0420, 0x0421, 0x0422, 0x0423, 0x0424, 0x0425, 0x0426, 0x0427,
+    0x0428, 0x0429, 0x042A, 0x042B, 0x042C, 0x042D, 0x042E, 0x042F,
+    0x0430, 0x0431, 0x0432, 0x0433, 0x0434, 0x0435, 0x0436, 0x0437,
+    0x0438, 0x0439, 0x043A, 0x043B, 0x043C, 0x043D, 0x043E, 0x043F,
+    0x0440, 0x0441, 0x0442, 0x0443, 0x0444, 0x0445, 0x0446, 0x0447,
+    0x0448, 0x0449, 0x044A, 0x044B, 0x044C, 0x044D, 0x044E, 0x044F
+  }
+};
+static const char *const NAMES[Codepage::COUNT] = {"utf8", "cp437", "cp866", "cp1251"};
+/*----------------------------------------------------------------------------*/
+namespace {
+/**Byte of every BMP char for each codepage*/
+struct ReverseTables {
+  uchar t[Codepage::COUNT][65536];
+  ReverseTables() {
+    for(int id = 0; id < Codepage::COUNT; id++) {
+      memset(t[id], Codepage::UNMAPPED, sizeof(t[id]));
+      for(int c = 0; c < 0x80; c++) {
+        t[id][c] = static_cast<uchar>(c);
+      }
+      if(id == Codepage::Utf8) {
+        continue;
+      }
+      for(int b = 0; b < 128; b++) {
+        if(UPPER[id][b] != QChar::ReplacementCharacter) {
+          t[id][UPPER[id][b]] = static_cast<uchar>(0x80 + b);
+        }
+      }
+    }
+  }
+};
+/*----------------------------------------------------------------------------*/
+const uchar *reverseTable(Codepage::Id id) {
+  static const ReverseTables tables;
+  return tables.t[id];
+}
+}
+/*----------------------------------------------------------------------------*/
+const char *Codepage::name(Id id) {
+  return id >= 0 && id < COUNT ? NAMES[id] : "";
+}
+/*----------------------------------------------------------------------------*/
+bool Codepage::fromName(const QString& name, Id *id) {
+  QString lower = name.toLower();
+  if(lower == "utf-8") {
+    *id = Utf8;
+    return true;
+  }
+  for(int i = 0; i < COUNT; i++) {
+    if(lower == NAMES[i]) {
+      *id = static_cast<Id>(i);
+      return true;
+    }
+  }
+  return false;
+}
+/*----------------------------------------------------------------------------*/
+ushort Codepage::decode(Id id, uchar byte) {
+  if(byte < 0x80) {
+    return byte;
+  }
+  return id == Utf8 ? static_cast<ushort>(QChar::ReplacementCharacter) : UPPER[id][byte - 0x80];
+}
+/*----------------------------------------------------------------------------*/
+QString Codepage::decode(Id id, const QByteArray& data) {
+  if(id == Utf8) {
+    return QString::fromUtf8(data);
+  }
+  const ushort *upper = UPPER[id];
+  QString result(data.size(), Qt::Uninitialized);
+  ushort *out = reinterpret_cast<ushort *>(result.data());
+  const uchar *p = reinterpret_cast<const uchar *>(data.constData());
+  for(int i = 0; i < data.size(); i++) {
+    uchar b = p[i];
+    out[i] = b < 0x80 ? b : upper[b - 0x80];
+  }
+  return result;
+}
+/*----------------------------------------------------------------------------*/
+char Codepage::encode(Id id, uint ucs) {
+  return static_cast<char>(ucs < 0x10000 ? reverseTable(id)[ucs] : static_cast<uchar>(UNMAPPED));
+}
+/*----------------------------------------------------------------------------*/
+QByteArray Codepage::encode(Id id, const QString& text) {
+  if(id == Utf8) {
+    return text.toUtf8();
+  }
+  const uchar *table = reverseTable(id);
+  QByteArray result(text.size(), Qt::Uninitialized);
+  char *out = result.data();
+  const ushort *p = reinterpret_cast<const ushort *>(text.constData());
+  const ushort *end = p + text.size();
+  for(; p < end; p++) {
+    if(QChar::isHighSurrogate(*p) && p + 1 < end && QChar::isLowSurrogate(p[1])) {
+      //Char above BMP is one byte
+      p++;
+      *out++ = UNMAPPED;
+      continue;
+    }
+    *out++ = static_cast<char>(table[*p]);
+  }
+  result.resize(static_cast<int>(out - result.constData()));
+  return result;
+}
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,49 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg codepage
+*/
+/**
+* Single byte codepages of POS printers: CP437, CP866, CP1251.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 22:15:00<br>
+* @pkgdoc codepage
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef CODEPAGE_H_1792275300
+#define CODEPAGE_H_1792275300
+/*----------------------------------------------------------------------------*/
+#include <QString>
+#include <QByteArray>
+/*----------------------------------------------------------------------------*/
+/**
+ * Table driven transcoding. Bytes 00..7F are ASCII in all codepages,
+ * upper half is mapped by 128 entry table, encoding uses 64K reverse table
+ * built on first use.
+ */
+class Codepage {
+public:
+  enum Id {
+    Utf8,   //Strings are sent as UTF-8, log shows ASCII only
+    Cp437,
+    Cp866,
+    Cp1251,
+    COUNT
+  };
+  enum {
+    UNMAPPED = '?' //Byte for chars missing in codepage
+  };
+  static const char *name(Id id);
+  /**Id by name: utf8, cp437, cp866, cp1251, case is ignored. Returns false if unknown*/
+  static bool fromName(const QString& name, Id *id);
+  /**Unicode of byte, ASCII for bytes below 0x80*/
+  static ushort decode(Id id, uchar byte);
+  static QString decode(Id id, const QByteArray& data);
+  /**Byte of Unicode char or UNMAPPED. Not used for Utf8*/
+  static char encode(Id id, uint ucs);
+  static QByteArray encode(Id id, const QString& text);
+};
+/*----------------------------------------------------------------------------*/
+#endif /*CODEPAGE_H_1792275300*/
@@ -1,30 +1,62 @@
 #include "connectiondialog.h"
 #include "ui_connectiondialog.h"
 #include "usbcon.h"
+#include "virtual_transport.h"
+#include "chardev_transport.h"
+#include "tcp_transport.h"
+#include <QFileDialog>
+#include <algorithm>
 
 ConnectionDialog::ConnectionDialog(QWidget *parent) :
   QDialog(parent),
   ui(new Ui::ConnectionDialog)
 {
   ui->setupUi(this);
-  deviceVector = usbDeviceList();
-
-  for(const auto& item : deviceVector) {
-    QString s = QString("%1:%2 %3,%4").arg(
-          QString::number(item.idVendor, 16),
-          QString::number(item.idProduct, 16),
-          QString::fromStdString(item.vendor),
-          QString::fromStdString(item.product));
-    ui->comboBox->addItem(s);
+
+  //Devices are streamed from service threads as their descriptors are read
+  listenerId = UsbService::instance().addListener([this](const UsbDeviceInfo& info, bool present) {
+    QMetaObject::invokeMethod(this, [this, info, present]() {
+      onDeviceListChanged(info, present);
+    }, Qt::QueuedConnection);
+  });
+
+  for(const auto& path : CharDeviceTransport::printerDevices()) {
+    ui->deviceComboBox->addItem(QString::fromStdString(path));
   }
 
 }
 
 ConnectionDialog::~ConnectionDialog()
 {
+  UsbService::instance().removeListener(listenerId);
   delete ui;
 }
 
+void ConnectionDialog::onDeviceListChanged(const UsbDeviceInfo& info, bool present)
+{
+  auto it = std::find_if(deviceVector.begin(), deviceVector.end(), [&info](const UsbDeviceInfo& item) {
+    return item.busNumber == info.busNumber && item.deviceAddress == info.deviceAddress;
+  });
+  if(!present) {
+    if(it != deviceVector.end()) {
+      ui->comboBox->removeItem(static_cast<int>(it - deviceVector.begin()));
+      deviceVector.erase(it);
+    }
+    return;
+  }
+  if(it != deviceVector.end()) {
+    return;
+  }
+  QString s = QString("%1:%2 %3,%4").arg(
+        QString::number(info.idVendor, 16),
+        QString::number(info.idProduct, 16),
+        QString::fromStdString(info.vendor),
+        QString::fromStdString(info.product));
+  //Vector first: addItem() may emit currentIndexChanged
+  deviceVector.push_back(info);
+  ui->comboBox->addItem(s);
+}
+
 void ConnectionDialog::onDeviceChanged(int i)
 {
   if(i >= 0 && i < (int) deviceVector.size()) {
@@ -51,3 +83,97 @@ uint16_t ConnectionDialog::pid() const
 {
   return ui->pidLineEdit->text().toUShort(nullptr, 16);
 }
+
+void ConnectionDialog::setUsbSettings(const UsbSettings& settings)
+{
+  ui->readQueueSpinBox->setValue(settings.readQueueDepth);
+  ui->readPacketsSpinBox->setValue(settings.readPackets);
+  ui->writeQueueSpinBox->setValue(settings.writeQueueDepth);
+  ui->writeChunkSpinBox->setValue(settings.writeChunkSize);
+  ui->zlpCheckBox->setChecked(settings.zeroLengthPacket);
+}
+
+UsbSettings ConnectionDialog::usbSettings() const
+{
+  UsbSettings settings;
+  settings.readQueueDepth = ui->readQueueSpinBox->value();
+  settings.readPackets = ui->readPacketsSpinBox->value();
+  settings.writeQueueDepth = ui->writeQueueSpinBox->value();
+  settings.writeChunkSize = ui->writeChunkSpinBox->value();
+  settings.zeroLengthPacket = ui->zlpCheckBox->isChecked();
+  return settings;
+}
+
+void ConnectionDialog::setAttachScript(const QString& fileName)
+{
+  ui->scriptLineEdit->setText(fileName);
+}
+
+QString ConnectionDialog::attachScript() const
+{
+  return ui->scriptLineEdit->text();
+}
+
+void ConnectionDialog::onScriptBrowse()
+{
+  auto fileName = QFileDialog::getOpenFileName(this,
+                                               tr("Attach script"), ui->scriptLineEdit->text(),
+                                               tr("Text files (*.txt);;All files(*.*)"));
+  if(!fileName.isEmpty()) {
+    ui->scriptLineEdit->setText(fileName);
+  }
+}
+
+void ConnectionDialog::setType(Type type)
+{
+  ui->typeComboBox->setCurrentIndex(type);
+}
+
+ConnectionDialog::Type ConnectionDialog::type() const
+{
+  return static_cast<Type>(ui->typeComboBox->currentIndex());
+}
+
+void ConnectionDialog::setVirtualSettings(const VirtualDeviceSettings& settings)
+{
+  ui->echoCheckBox->setChecked(settings.echo);
+  ui->rateSpinBox->setValue(static_cast<int>(settings.sinkRate / 1000));
+  ui->latencySpinBox->setValue(settings.latencyMs);
+}
+
+VirtualDeviceSettings ConnectionDialog::virtualSettings() const
+{
+  VirtualDeviceSettings settings;
+  settings.echo = ui->echoCheckBox->isChecked();
+  settings.sinkRate = ui->rateSpinBox->value() * 1000.0;
+  settings.latencyMs = ui->latencySpinBox->value();
+  return settings;
+}
+
+void ConnectionDialog::setDeviceFile(const QString& path)
+{
+  if(!path.isEmpty()) {
+    ui->deviceComboBox->setCurrentText(path);
+  }
+}
+
+QString ConnectionDialog::deviceFile() const
+{
+  return ui->deviceComboBox->currentText();
+}
+
+void ConnectionDialog::setTcpSettings(const TcpSettings& settings)
+{
+  ui->hostLineEdit->setText(QString::fromStdString(settings.host));
+  ui->portSpinBox->setValue(settings.port);
+  ui->noDelayCheckBox->setChecked(settings.noDelay);
+}
+
+TcpSettings ConnectionDialog::tcpSettings() const
+{
+  TcpSettings settings;
+  settings.host = ui->hostLineEdit->text().trimmed().toStdString();
+  settings.port = static_cast<uint16_t>(ui->portSpinBox->value());
+  settings.noDelay = ui->noDelayCheckBox->isChecked();
+  return settings;
+}
@@ -8,11 +8,24 @@ class ConnectionDialog;
 }
 
 struct UsbDeviceInfo;
+struct UsbSettings;
+struct VirtualDeviceSettings;
+struct TcpSettings;
 class ConnectionDialog : public QDialog
 {
   Q_OBJECT
   std::vector<UsbDeviceInfo> deviceVector;
+  int listenerId = 0;
+  void onDeviceListChanged(const UsbDeviceInfo& info, bool present);
 public:
+  /**Connection type, index of the type combo box and settings page*/
+  enum Type {
+    Usb,
+    Virtual,
+    CharDevice,
+    Tcp,
+    Pty
+  };
   explicit ConnectionDialog(QWidget *parent = nullptr);
   ~ConnectionDialog();
 
@@ -22,8 +35,27 @@ public:
   uint16_t vid() const;
   uint16_t pid() const;
 
+  void setUsbSettings(const UsbSettings&);
+  UsbSettings usbSettings() const;
+
+  void setAttachScript(const QString&);
+  QString attachScript() const;
+
+  void setType(Type type);
+  Type type() const;
+
+  void setVirtualSettings(const VirtualDeviceSettings&);
+  VirtualDeviceSettings virtualSettings() const;
+
+  void setDeviceFile(const QString&);
+  QString deviceFile() const;
+
+  void setTcpSettings(const TcpSettings&);
+  TcpSettings tcpSettings() const;
+
 protected slots:
   void onDeviceChanged(int i);
+  void onScriptBrowse();
 private:
   Ui::ConnectionDialog *ui;
 };
@@ -0,0 +1,152 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg crc
+*/
+/**
+* Checksums used in device frames: CRC-16/CCITT, CRC-32, XOR LRC.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 21:30:00<br>
+* @pkgdoc crc
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "crc.h"
+#include <QByteArray>
+#include <string.h>
+/*----------------------------------------------------------------------------*/
+namespace {
+/**
+ * Slice tables: t[k][b] is CRC of byte b followed by k zero bytes.
+ * Built once on first use.
+ */
+struct Crc16Tables {
+  quint16 t[8][256];
+  Crc16Tables() {
+    for(int i = 0; i < 256; i++) {
+      quint16 crc = static_cast<quint16>(i << 8);
+      for(int bit = 0; bit < 8; bit++) {
+        crc = static_cast<quint16>(crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1);
+      }
+      t[0][i] = crc;
+    }
+    for(int k = 1; k < 8; k++) {
+      for(int i = 0; i < 256; i++) {
+        t[k][i] = static_cast<quint16>((t[k - 1][i] << 8) ^ t[0][t[k - 1][i] >> 8]);
+      }
+    }
+  }
+};
+/*----------------------------------------------------------------------------*/
+struct Crc32Tables {
+  quint32 t[8][256];
+  Crc32Tables() {
+    for(quint32 i = 0; i < 256; i++) {
+      quint32 crc = i;
+      for(int bit = 0; bit < 8; bit++) {
+        crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+      }
+      t[0][i] = crc;
+    }
+    for(int k = 1; k < 8; k++) {
+      for(int i = 0; i < 256; i++) {
+        t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xff];
+      }
+    }
+  }
+};
+/*----------------------------------------------------------------------------*/
+inline quint32 readLe32(const uchar *p) {
+  return static_cast<quint32>(p[0]) | static_cast<quint32>(p[1]) << 8
+      | static_cast<quint32>(p[2]) << 16 | static_cast<quint32>(p[3]) << 24;
+}
+}
+/*----------------------------------------------------------------------------*/
+quint16 Crc::crc16(const void *data, size_t size, quint16 crc) {
+  static const Crc16Tables tables;
+  const auto& t = tables.t;
+  const uchar *p = static_cast<const uchar *>(data);
+  for(; size >= 8; size -= 8, p += 8) {
+    crc = t[7][p[0] ^ (crc >> 8)] ^ t[6][p[1] ^ (crc & 0xff)] ^ t[5][p[2]] ^ t[4][p[3]]
+        ^ t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+  }
+  for(; size; size--) {
+    crc = static_cast<quint16>((crc << 8) ^ t[0][(crc >> 8) ^ *p++]);
+  }
+  return crc;
+}
+/*----------------------------------------------------------------------------*/
+quint32 Crc::crc32(const void *data, size_t size, quint32 crc) {
+  static const Crc32Tables tables;
+  const auto& t = tables.t;
+  const uchar *p = static_cast<const uchar *>(data);
+  crc = ~crc;
+  for(; size >= 8; size -= 8, p += 8) {
+    quint32 lo = readLe32(p) ^ crc;
+    quint32 hi = readLe32(p + 4);
+    crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24]
+        ^ t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+  }
+  for(; size; size--) {
+    crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+  }
+  return ~crc;
+}
+/*----------------------------------------------------------------------------*/
+quint8 Crc::xor8(const void *data, size_t size, quint8 lrc) {
+  const uchar *p = static_cast<const uchar *>(data);
+  quint64 acc = 0;
+  for(; size >= 8; size -= 8, p += 8) {
+    quint64 word;
+    memcpy(&word, p, 8);
+    acc ^= word;
+  }
+  for(int shift = 32; shift >= 8; shift /= 2) {
+    acc ^= acc >> shift;
+  }
+  lrc ^= static_cast<quint8>(acc);
+  for(; size; size--) {
+    lrc ^= *p++;
+  }
+  return lrc;
+}
+/*----------------------------------------------------------------------------*/
+int Crc::size(Kind kind) {
+  switch(kind) {
+    case Crc16: return 2;
+    case Crc32: return 4;
+    default: return 1;
+  }
+}
+/*----------------------------------------------------------------------------*/
+quint32 Crc::init(Kind kind) {
+  switch(kind) {
+    case Crc16: return CRC16_INIT;
+    case Crc32: return CRC32_INIT;
+    default: return 0;
+  }
+}
+/*----------------------------------------------------------------------------*/
+quint32 Crc::update(Kind kind, const void *data, size_t size, quint32 state) {
+  switch(kind) {
+    case Crc16: return crc16(data, size, static_cast<quint16>(state));
+    case Crc32: return crc32(data, size, state);
+    default: return xor8(data, size, static_cast<quint8>(state));
+  }
+}
+/*----------------------------------------------------------------------------*/
+bool Crc::checkFrame(Kind kind, const void *frame, size_t size, bool bigEndian) {
+  size_t crcSize = static_cast<size_t>(Crc::size(kind));
+  if(size < crcSize) {
+    return false;
+  }
+  const uchar *p = static_cast<const uchar *>(frame);
+  size -= crcSize;
+  quint32 stored = 0;
+  for(size_t i = 0; i < crcSize; i++) {
+    stored |= static_cast<quint32>(p[size + i]) << ((bigEndian ? crcSize - 1 - i : i) * 8);
+  }
+  return update(kind, p, size, init(kind)) == stored;
+}
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,50 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg crc
+*/
+/**
+* Checksums used in device frames: CRC-16/CCITT, CRC-32, XOR LRC.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 21:30:00<br>
+* @pkgdoc crc
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef CRC_H_1792272600
+#define CRC_H_1792272600
+/*----------------------------------------------------------------------------*/
+#include <QtGlobal>
+#include <stddef.h>
+/*----------------------------------------------------------------------------*/
+/**
+ * Table driven kernels, slice-by-8: 8 bytes per step.
+ * Functions take state of previous call, so data can be processed by parts:
+ * crc = Crc::crc32(part2, n2, Crc::crc32(part1, n1)).
+ */
+namespace Crc {
+  enum Kind {
+    Crc16,  //CRC-16/CCITT-FALSE: poly 0x1021, init 0xFFFF, not reflected
+    Crc32,  //CRC-32 (Ethernet, zip): poly 0x04C11DB7 reflected, init and final xor 0xFFFFFFFF
+    Xor8    //XOR of all bytes (LRC)
+  };
+  enum {
+    CRC16_INIT = 0xFFFF,
+    CRC32_INIT = 0
+  };
+  quint16 crc16(const void *data, size_t size, quint16 crc = CRC16_INIT);
+  quint32 crc32(const void *data, size_t size, quint32 crc = CRC32_INIT);
+  quint8 xor8(const void *data, size_t size, quint8 lrc = 0);
+
+  /**Size of checksum in bytes*/
+  int size(Kind kind);
+  /**Initial state of checksum*/
+  quint32 init(Kind kind);
+  /**Add data to checksum state*/
+  quint32 update(Kind kind, const void *data, size_t size, quint32 state);
+  /**Frame ends with checksum of preceding bytes, as {crc16:0..} of script makes it*/
+  bool checkFrame(Kind kind, const void *frame, size_t size, bool bigEndian);
+}
+/*----------------------------------------------------------------------------*/
+#endif /*CRC_H_1792272600*/
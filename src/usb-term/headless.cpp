@@ -0,0 +1,232 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg headless
+*/
+/**
+* Command line mode without main window.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 16:52:10<br>
+* @pkgdoc headless
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "headless.h"
+#include "usbcon.h"
+#include "virtual_transport.h"
+#include "chardev_transport.h"
+#include "tcp_transport.h"
+#include "send_file.h"
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QScopedPointer>
+#include <stdio.h>
+#include <thread>
+#include <chrono>
+/*----------------------------------------------------------------------------*/
+/**
+ * Pipeline options of usb connection string: read-queue=N, read-packets=N,
+ * write-queue=N, write-chunk=BYTES, zlp=0|1.
+ */
+static bool parseUsbOptions(const QStringList& options, UsbSettings *settings, QString *error)
+{
+  for(const QString& option : options) {
+    QString key = option.section('=', 0, 0);
+    bool ok = false;
+    int value = option.section('=', 1).toInt(&ok);
+    if(!ok || value < 0) {
+      *error = QString("Bad usb option '%1'").arg(option);
+      return false;
+    }
+    if(key == "read-queue" && value > 0) {
+      settings->readQueueDepth = value;
+    } else if(key == "read-packets" && value > 0) {
+      settings->readPackets = value;
+    } else if(key == "write-queue" && value > 0) {
+      settings->writeQueueDepth = value;
+    } else if(key == "write-chunk" && value > 0) {
+      settings->writeChunkSize = value;
+    } else if(key == "zlp" && value <= 1) {
+      settings->zeroLengthPacket = value != 0;
+    } else {
+      *error = QString("Bad usb option '%1', expected read-queue, read-packets, write-queue, write-chunk or zlp").arg(option);
+      return false;
+    }
+  }
+  return true;
+}
+/*----------------------------------------------------------------------------*/
+Transport *openTransport(const QString& connection, QString *error)
+{
+  QString type = connection.section(':', 0, 0);
+  QString args = connection.section(':', 1);
+
+  if(type == "usb") {
+    QStringList options = args.split(',');
+    QStringList ids = options.takeFirst().split(':');
+    bool okVid = false, okPid = false;
+    uint16_t vid = ids.value(0).toUShort(&okVid, 16);
+    uint16_t pid = ids.value(1).toUShort(&okPid, 16);
+    if(ids.size() != 2 || !okVid || !okPid) {
+      *error = "Expected usb:VID:PID in hex";
+      return nullptr;
+    }
+    UsbSettings settings;
+    if(!parseUsbOptions(options, &settings, error)) {
+      return nullptr;
+    }
+    auto con = new UsbConnection();
+    con->setSettings(settings);
+    if(!con->open(vid, pid)) {
+      *error = QString::fromStdString(con->message());
+      delete con;
+      return nullptr;
+    }
+    return con;
+  }
+
+  if(type == "tcp") {
+    TcpSettings settings;
+    settings.host = args.section(':', 0, 0).toStdString();
+    if(args.contains(':')) {
+      settings.port = args.section(':', 1).toUShort();
+    }
+    if(settings.host.empty() || settings.port == 0) {
+      *error = "Expected tcp:HOST[:PORT]";
+      return nullptr;
+    }
+    auto con = new TcpTransport();
+    if(!con->open(settings)) {
+      *error = QString::fromStdString(con->message());
+      delete con;
+      return nullptr;
+    }
+    return con;
+  }
+
+  if(type == "dev") {
+    auto con = new CharDeviceTransport();
+    if(!con->open(args.toStdString())) {
+      *error = QString::fromStdString(con->message());
+      delete con;
+      return nullptr;
+    }
+    return con;
+  }
+
+  if(type == "virtual") {
+    VirtualDeviceSettings settings;
+    settings.echo = false;
+    settings.sinkRate = args.toDouble() * 1000;
+    auto con = new VirtualTransport();
+    con->open(settings);
+    return con;
+  }
+
+  *error = QString("Unknown connection type '%1'").arg(type);
+  return nullptr;
+}
+/*----------------------------------------------------------------------------*/
+int sendFileHeadless(const QString& fileName, const QString& connection, bool binary, bool useCache, Codepage::Id codepage,
+                     int timeoutSec)
+{
+  QString error;
+  Transport *transport = openTransport(connection, &error);
+  if(!transport) {
+    fprintf(stderr, "%s: %s\n", qPrintable(connection), qPrintable(error));
+    return 1;
+  }
+  fprintf(stderr, "Connected to %s\n", transport->name().c_str());
+
+  int result = 0;
+  {
+    QScopedPointer<FileSender> sender;
+    if(binary) {
+      sender.reset(new BinaryFileSender(transport));
+    } else {
+      auto script = new ScriptFileSender(transport);
+      script->setUseCache(useCache);
+      script->setCodepage(codepage);
+      sender.reset(script);
+    }
+    if(!sender->start(fileName)) {
+      fprintf(stderr, "%s: %s\n", qPrintable(fileName), qPrintable(sender->message()));
+      delete transport;
+      return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 reported = 0;
+    //Device gone for good or not accepting queued data: no end otherwise
+    qint64 detached = -1;
+    qint64 accepted = 0;
+    qint64 progress = 0;
+    QString timeout;
+    for(;;) {
+      TransportEvent event;
+      while(transport->poll(&event)) {
+        if(event.type == TransportEvent::Error || event.type == TransportEvent::Detached
+           || event.type == TransportEvent::Attached || event.type == TransportEvent::Recovery) {
+          fprintf(stderr, "%s\n", event.message.c_str());
+        }
+        if(event.type == TransportEvent::Detached && detached < 0) {
+          detached = timer.elapsed();
+        } else if(event.type == TransportEvent::Attached) {
+          detached = -1;
+          progress = timer.elapsed();
+        }
+      }
+      if(sender->isFinished() && (sender->isError() || transport->pendingBytes() == 0)) {
+        break;
+      }
+      qint64 done = sender->sent() - transport->pendingBytes();
+      if(done != accepted || transport->pendingBytes() == 0) {
+        accepted = done;
+        progress = timer.elapsed();
+      }
+      if(timeoutSec > 0 && detached >= 0 && timer.elapsed() - detached >= timeoutSec * 1000LL) {
+        timeout = QString("Device is detached for %1 s").arg(timeoutSec);
+      } else if(timeoutSec > 0 && detached < 0 && timer.elapsed() - progress >= timeoutSec * 1000LL) {
+        timeout = QString("Device accepted no data for %1 s").arg(timeoutSec);
+      }
+      if(!timeout.isEmpty()) {
+        sender->cancel();
+        break;
+      }
+      if(timer.elapsed() - reported >= 1000) {
+        reported = timer.elapsed();
+        fprintf(stderr, "Processed %lld of %lld bytes, sent %lld bytes, %.3f MB/s\n",
+                sender->processed(), sender->fileSize(),
+                static_cast<long long>(sender->sent() - transport->pendingBytes()),
+                (sender->sent() - transport->pendingBytes()) / 1e3 / timer.elapsed());
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    double sec = timer.nsecsElapsed() / 1e9;
+    if(sender->isCached()) {
+      fprintf(stderr, "Compiled script loaded from cache\n");
+    }
+    QString timing = sender->timingReport();
+    if(!timing.isEmpty()) {
+      fprintf(stderr, "%s\n", qPrintable(timing));
+    }
+    if(!timeout.isEmpty()) {
+      fprintf(stderr, "%s: %s, processed %lld of %lld bytes\n", qPrintable(connection), qPrintable(timeout),
+              sender->processed(), sender->fileSize());
+      result = 1;
+    } else if(sender->isError()) {
+      fprintf(stderr, "%s: %s\n", qPrintable(fileName), qPrintable(sender->message()));
+      result = 1;
+    } else {
+      fprintf(stderr, "Sent %lld bytes in %.3f s, %.3f MB/s\n",
+              sender->sent(), sec, sec > 0 ? sender->sent() / 1e6 / sec : 0);
+    }
+  }
+  delete transport;
+  return result;
+}
+/*----------------------------------------------------------------------------*/
+
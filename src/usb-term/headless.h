@@ -0,0 +1,40 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg headless
+*/
+/**
+* Command line mode without main window.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 16:52:10<br>
+* @pkgdoc headless
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef HEADLESS_H_1792255930
+#define HEADLESS_H_1792255930
+/*----------------------------------------------------------------------------*/
+#include <QString>
+#include "codepage.h"
+/*----------------------------------------------------------------------------*/
+class Transport;
+/**
+ * Create and open transport by connection string:
+ * usb:VID:PID[,option=value...], tcp:HOST[:PORT], dev:PATH, virtual[:KB/s].
+ * Usb options: read-queue, read-packets, write-queue, write-chunk, zlp.
+ * Returns nullptr and error message on failure.
+ */
+Transport *openTransport(const QString& connection, QString *error);
+
+/**
+ * Send script file (or binary file as is) and wait until device accepts all data.
+ * Compiled script is taken from cache unless useCache is false.
+ * Script strings are encoded in codepage until the first @codepage.
+ * Progress is printed to stderr. Returns process exit code.
+ * Fails when device stays detached, or does not accept queued data, for timeoutSec; 0 waits forever.
+ */
+int sendFileHeadless(const QString& fileName, const QString& connection, bool binary = false, bool useCache = true,
+                     Codepage::Id codepage = Codepage::Utf8, int timeoutSec = 30);
+/*----------------------------------------------------------------------------*/
+#endif /*HEADLESS_H_1792255930*/
@@ -16,8 +16,98 @@
 #define HEX_DUMP_H_1761554524
 /*----------------------------------------------------------------------------*/
 #include <QByteArray>
-QString hexDump(const QByteArray& data);
-void hexDumpTest();
+#include <QString>
+#include <string.h>
+#include "codepage.h"
+/*----------------------------------------------------------------------------*/
+namespace HexDump {
+  struct HexPairs {
+    ushort t[256][2];
+    constexpr HexPairs() : t() {
+      for(int i = 0; i < 256; i++) {
+        t[i][0] = static_cast<ushort>("0123456789ABCDEF"[i >> 4]);
+        t[i][1] = static_cast<ushort>("0123456789ABCDEF"[i & 0xf]);
+      }
+    }
+  };
+  /**Two upper case hex digits of every byte*/
+  inline constexpr HexPairs HEX_PAIRS;
+  /**Char of text column for every byte: printable ASCII, codepage upper half or '.'*/
+  void textTable(Codepage::Id codepage, ushort table[256]);
+  /**Offset, at least 4 hex digits*/
+  inline ushort *putOffset(ushort *out, uint offset) {
+    int digits = 4;
+    while(digits < 8 && (offset >> (digits * 4))) {
+      digits++;
+    }
+    for(int i = digits - 1; i >= 0; i--) {
+      *out++ = HEX_PAIRS.t[(offset >> (i * 4)) & 0xf][1];
+    }
+    return out;
+  }
+}
+namespace HexDump {
+  /**Chars of row of ROW bytes: offset of up to 8 digits, hex, text, line feed*/
+  template<int ROW, int GROUP>
+  constexpr int lineMax() {
+    return 8 + 2 + ROW * 3 + ROW / GROUP - 1 + 1 + ROW + 1;
+  }
+  /**
+   * Row "0010: 41 42 ... 4F  50 ... 5F  AB..P...\n" of count <= ROW bytes,
+   * extra space between groups of GROUP bytes. Returns end of written chars.
+   */
+  template<int ROW = 16, int GROUP = 8>
+  ushort *putRow(ushort *out, const uchar *p, int count, uint offset, const ushort text[256]) {
+    static_assert(ROW > 0 && GROUP > 0 && ROW % GROUP == 0, "Row must be whole groups");
+    out = putOffset(out, offset);
+    *out++ = ':';
+    *out++ = ' ';
+    for(int j = 0; j < ROW; j++) {
+      if(j < count) {
+        memcpy(out, HEX_PAIRS.t[p[j]], sizeof(HEX_PAIRS.t[0]));
+      } else {
+        out[0] = ' ';
+        out[1] = ' ';
+      }
+      out[2] = ' ';
+      out += 3;
+      if(j % GROUP == GROUP - 1 && j != ROW - 1) {
+        *out++ = ' ';
+      }
+    }
+    *out++ = ' ';
+    for(int j = 0; j < count; j++) {
+      out[j] = text[p[j]];
+    }
+    out += count;
+    *out++ = '\n';
+    return out;
+  }
+}
+/**
+ * Dump rows of ROW bytes by HexDump::putRow().
+ * Output is written by lookup tables to one buffer sized for the whole dump.
+ */
+template<int ROW = 16, int GROUP = 8>
+QString hexDumpRows(const QByteArray& data, Codepage::Id codepage = Codepage::Utf8) {
+  int size = data.size();
+  if(!size) {
+    return QString();
+  }
+  ushort text[256];
+  HexDump::textTable(codepage, text);
+  const uchar *p = reinterpret_cast<const uchar *>(data.constData());
+  qint64 rows = (static_cast<qint64>(size) + ROW - 1) / ROW;
+  QString result(static_cast<int>(rows * HexDump::lineMax<ROW, GROUP>()), Qt::Uninitialized);
+  ushort *begin = reinterpret_cast<ushort *>(result.data());
+  ushort *out = begin;
+  for(int i = 0; i < size; i += ROW, p += ROW) {
+    out = HexDump::putRow<ROW, GROUP>(out, p, size - i < ROW ? size - i : ROW, static_cast<uint>(i), text);
+  }
+  result.resize(static_cast<int>(out - begin));
+  return result;
+}
+/**Text column shows bytes 80..FF decoded in codepage, ASCII only for Utf8*/
+QString hexDump(const QByteArray& data, Codepage::Id codepage = Codepage::Utf8);
 /*----------------------------------------------------------------------------*/
 #endif /*HEX_DUMP_H_1761554524*/
-
@@ -0,0 +1,225 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg hex_view
+*/
+/**
+* Log view: titles and hex dumps formatted on paint from raw bytes.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 23:05:00<br>
+* @pkgdoc hex_view
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "hex_view.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QMouseEvent>
+#include <QKeyEvent>
+#include <QScrollBar>
+#include <QFontDatabase>
+#include <QApplication>
+#include <QClipboard>
+#include <string.h>
+#include <limits.h>
+#include <algorithm>
+/*----------------------------------------------------------------------------*/
+HexView::HexView(QWidget *parent) : QAbstractScrollArea(parent) {
+  setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+  setFocusPolicy(Qt::StrongFocus);
+  HexDump::textTable(m_codepage, m_text);
+}
+/*----------------------------------------------------------------------------*/
+void HexView::append(const QString& title, const QColor& color, const QByteArray& data) {
+  Section section;
+  section.firstLine = m_lines;
+  section.offset = m_size;
+  section.size = data.size();
+  section.title = title;
+  section.color = color.rgb();
+  section.titleLines = title.count('\n') + 1;
+  for(const QString& line : title.split('\n')) {
+    m_columns = std::max(m_columns, static_cast<int>(line.size()));
+  }
+  const char *p = data.constData();
+  int size = data.size();
+  while(size) {
+    if(m_pages.isEmpty() || m_pages.last().size() == PAGE_BYTES) {
+      m_pages.append(QByteArray());
+      m_pages.last().reserve(PAGE_BYTES);
+    }
+    QByteArray& page = m_pages.last();
+    int part = std::min(size, PAGE_BYTES - static_cast<int>(page.size()));
+    page.append(p, part);
+    p += part;
+    size -= part;
+  }
+  m_size += section.size;
+  m_lines += section.titleLines + (section.size + ROW - 1) / ROW;
+  if(section.size) {
+    m_columns = std::max(m_columns, ROW_CHARS - 1);
+  }
+  m_sections.append(section);
+  updateScrollBars();
+  viewport()->update();
+}
+/*----------------------------------------------------------------------------*/
+void HexView::clear() {
+  m_pages.clear();
+  m_sections.clear();
+  m_size = 0;
+  m_lines = 0;
+  m_columns = 0;
+  m_anchor = m_cursor = -1;
+  updateScrollBars();
+  viewport()->update();
+}
+/*----------------------------------------------------------------------------*/
+void HexView::scrollToBottom() {
+  verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+}
+/*----------------------------------------------------------------------------*/
+void HexView::setCodepage(Codepage::Id codepage) {
+  m_codepage = codepage;
+  HexDump::textTable(m_codepage, m_text);
+  viewport()->update();
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Index of section containing line, binary search by first lines.
+ */
+int HexView::sectionAt(qint64 line) const {
+  auto it = std::upper_bound(m_sections.begin(), m_sections.end(), line,
+                             [](qint64 line, const Section& section) {return line < section.firstLine;});
+  return static_cast<int>(it - m_sections.begin()) - 1;
+}
+/*----------------------------------------------------------------------------*/
+qint64 HexView::lineAt(int y) const {
+  qint64 line = verticalScrollBar()->value() + y / fontMetrics().lineSpacing();
+  return std::max<qint64>(0, std::min(line, m_lines - 1));
+}
+/*----------------------------------------------------------------------------*/
+void HexView::read(qint64 offset, int size, uchar *out) const {
+  while(size) {
+    const QByteArray& page = m_pages[static_cast<int>(offset / PAGE_BYTES)];
+    int from = static_cast<int>(offset % PAGE_BYTES);
+    int part = std::min(size, PAGE_BYTES - from);
+    memcpy(out, page.constData() + from, part);
+    out += part;
+    offset += part;
+    size -= part;
+  }
+}
+/*----------------------------------------------------------------------------*/
+QString HexView::lineText(qint64 line, QRgb *color) const {
+  int index = sectionAt(line);
+  if(index < 0 || line >= m_lines) {
+    return QString();
+  }
+  const Section& section = m_sections[index];
+  if(color) {
+    *color = section.color;
+  }
+  qint64 row = line - section.firstLine;
+  if(row < section.titleLines) {
+    return section.title.section('\n', static_cast<int>(row), static_cast<int>(row));
+  }
+  qint64 start = (row - section.titleLines) * ROW;
+  int count = static_cast<int>(std::min<qint64>(ROW, section.size - start));
+  uchar bytes[ROW];
+  read(section.offset + start, count, bytes);
+  ushort buffer[ROW_CHARS];
+  ushort *end = HexDump::putRow<ROW, GROUP>(buffer, bytes, count, static_cast<uint>(start), m_text);
+  return QString(reinterpret_cast<const QChar *>(buffer), static_cast<int>(end - buffer - 1));
+}
+/*----------------------------------------------------------------------------*/
+void HexView::paintEvent(QPaintEvent *e) {
+  QPainter painter(viewport());
+  const QFontMetrics metrics = fontMetrics();
+  int height = metrics.lineSpacing();
+  qint64 top = verticalScrollBar()->value();
+  qint64 first = top + e->rect().top() / height;
+  qint64 last = std::min(m_lines, top + e->rect().bottom() / height + 1);
+  qint64 selectFrom = std::min(m_anchor, m_cursor);
+  qint64 selectTo = std::max(m_anchor, m_cursor);
+  int x = MARGIN - horizontalScrollBar()->value();
+  for(qint64 line = first; line < last; line++) {
+    int y = static_cast<int>(line - top) * height;
+    QRgb color = 0;
+    QString text = lineText(line, &color);
+    if(line >= selectFrom && line <= selectTo) {
+      painter.fillRect(0, y, viewport()->width(), height, palette().highlight());
+      painter.setPen(palette().highlightedText().color());
+    } else {
+      painter.setPen(QColor(color));
+    }
+    painter.drawText(x, y + metrics.ascent(), text);
+  }
+}
+/*----------------------------------------------------------------------------*/
+void HexView::resizeEvent(QResizeEvent *e) {
+  QAbstractScrollArea::resizeEvent(e);
+  updateScrollBars();
+}
+/*----------------------------------------------------------------------------*/
+void HexView::changeEvent(QEvent *e) {
+  QAbstractScrollArea::changeEvent(e);
+  if(e->type() == QEvent::FontChange) {
+    updateScrollBars();
+  }
+}
+/*----------------------------------------------------------------------------*/
+void HexView::mousePressEvent(QMouseEvent *e) {
+  if(e->button() == Qt::LeftButton && m_lines) {
+    m_cursor = lineAt(e->pos().y());
+    if(!(e->modifiers() & Qt::ShiftModifier) || m_anchor < 0) {
+      m_anchor = m_cursor;
+    }
+    viewport()->update();
+  }
+}
+/*----------------------------------------------------------------------------*/
+void HexView::mouseMoveEvent(QMouseEvent *e) {
+  if((e->buttons() & Qt::LeftButton) && m_anchor >= 0) {
+    m_cursor = lineAt(e->pos().y());
+    viewport()->update();
+  }
+}
+/*----------------------------------------------------------------------------*/
+void HexView::keyPressEvent(QKeyEvent *e) {
+  if(e->matches(QKeySequence::Copy) && m_anchor >= 0) {
+    qint64 from = std::min(m_anchor, m_cursor);
+    qint64 to = std::min(std::max(m_anchor, m_cursor), from + COPY_LINES_MAX - 1);
+    QString text;
+    for(qint64 line = from; line <= to; line++) {
+      text += lineText(line);
+      text += '\n';
+    }
+    QApplication::clipboard()->setText(text);
+    return;
+  }
+  if(e->matches(QKeySequence::SelectAll) && m_lines) {
+    m_anchor = 0;
+    m_cursor = m_lines - 1;
+    viewport()->update();
+    return;
+  }
+  QAbstractScrollArea::keyPressEvent(e);
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Vertical scroll bar counts lines, horizontal one pixels.
+ */
+void HexView::updateScrollBars() {
+  const QFontMetrics metrics = fontMetrics();
+  int page = std::max(1, viewport()->height() / metrics.lineSpacing());
+  qint64 maximum = std::min<qint64>(std::max<qint64>(0, m_lines - page), INT_MAX);
+  verticalScrollBar()->setPageStep(page);
+  verticalScrollBar()->setRange(0, static_cast<int>(maximum));
+  int width = m_columns * metrics.horizontalAdvance(QLatin1Char('0')) + 2 * MARGIN;
+  horizontalScrollBar()->setPageStep(viewport()->width());
+  horizontalScrollBar()->setSingleStep(metrics.horizontalAdvance(QLatin1Char('0')));
+  horizontalScrollBar()->setRange(0, std::max(0, width - viewport()->width()));
+}
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,90 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg hex_view
+*/
+/**
+* Log view: titles and hex dumps formatted on paint from raw bytes.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 23:05:00<br>
+* @pkgdoc hex_view
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef HEX_VIEW_H_1792278300
+#define HEX_VIEW_H_1792278300
+/*----------------------------------------------------------------------------*/
+#include <QAbstractScrollArea>
+#include <QByteArray>
+#include <QColor>
+#include <QVector>
+#include "hex_dump.h"
+/*----------------------------------------------------------------------------*/
+/**
+ * Sections of title lines followed by dump of data. Only raw bytes are kept,
+ * in pages of PAGE_BYTES, so memory is about size of data. Rows are formatted
+ * when painted, only those on screen.
+ * Mouse selects lines, Ctrl+C copies them as text.
+ */
+class HexView : public QAbstractScrollArea
+{
+  Q_OBJECT
+
+public:
+  explicit HexView(QWidget *parent = nullptr);
+  /**Adds section, title may have several lines*/
+  void append(const QString& title, const QColor& color, const QByteArray& data = QByteArray());
+  void clear();
+  void scrollToBottom();
+  /**Bytes of all sections*/
+  qint64 dataSize() const {return m_size;}
+  qint64 lineCount() const {return m_lines;}
+  /**Line as painted, without line feed*/
+  QString lineText(qint64 line, QRgb *color = nullptr) const;
+  /**Codepage of text column, applies to data already shown*/
+  Codepage::Id codepage() const {return m_codepage;}
+  void setCodepage(Codepage::Id codepage);
+
+protected:
+  void paintEvent(QPaintEvent *e) override;
+  void resizeEvent(QResizeEvent *e) override;
+  void changeEvent(QEvent *e) override;
+  void mousePressEvent(QMouseEvent *e) override;
+  void mouseMoveEvent(QMouseEvent *e) override;
+  void keyPressEvent(QKeyEvent *e) override;
+
+private:
+  enum {
+    ROW = 16,
+    GROUP = 8,
+    ROW_CHARS = HexDump::lineMax<ROW, GROUP>(),
+    PAGE_BYTES = 1 << 20,
+    MARGIN = 4,
+    COPY_LINES_MAX = 1 << 20 //Clipboard limit
+  };
+  struct Section {
+    qint64 firstLine;
+    qint64 offset;    //Data in pages
+    qint64 size;
+    QString title;
+    QRgb color;
+    int titleLines;
+  };
+  QVector<QByteArray> m_pages;
+  qint64 m_size = 0;
+  QVector<Section> m_sections;
+  qint64 m_lines = 0;
+  int m_columns = 0;          //Chars of widest line
+  qint64 m_anchor = -1;       //Selected lines from anchor to cursor
+  qint64 m_cursor = -1;
+  Codepage::Id m_codepage = Codepage::Utf8;
+  ushort m_text[256];
+
+  int sectionAt(qint64 line) const;
+  qint64 lineAt(int y) const;
+  void read(qint64 offset, int size, uchar *out) const;
+  void updateScrollBars();
+};
+/*----------------------------------------------------------------------------*/
+#endif /*HEX_VIEW_H_1792278300*/
@@ -1,18 +1,39 @@
 #include "inputform.h"
 #include "ui_inputform.h"
-#include "hex_dump.h"
-#include <QTime>
-#include <QScrollBar>
+#include <QSpinBox>
+#include <QLabel>
+#include <algorithm>
 
 InputForm::InputForm(QWidget *parent) :
   QWidget(parent),
   ui(new Ui::InputForm)
 {
   ui->setupUi(this);
-  timer.setSingleShot(true);
-  timer.setInterval(100);
+  model = new LogModel(&store, this);
+  delegate = new LogDelegate(this);
+  ui->logView->setFont(ui->hexView->font());
+  ui->logView->setModel(model);
+  ui->logView->setItemDelegate(delegate);
+  connect(ui->logView->selectionModel(), &QItemSelectionModel::selectionChanged, this, &InputForm::onSelectionChanged);
+
+  limitBox = new QSpinBox(this);
+  limitBox->setRange(100, 10000000);
+  limitBox->setSingleStep(1000);
+  limitBox->setValue(model->limit());
+  limitBox->setPrefix(tr("Keep "));
+  limitBox->setSuffix(tr(" entries"));
+  limitBox->setToolTip(tr("Oldest log entries are removed above this count"));
+  ui->toolBar->addWidget(limitBox);
+  connect(limitBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &InputForm::setEntryLimit);
 
-  connect(&timer, &QTimer::timeout, this, &InputForm::onAfterLog);
+  decimationLabel = new QLabel(this);
+  decimationLabel->setStyleSheet("color: orange;");
+  decimationLabel->setToolTip(tr("Log view is refreshed less often to keep up, received data is kept whole"));
+  decimationAction = ui->toolBar->addWidget(decimationLabel);
+  decimationAction->setVisible(false);
+
+  timer.setSingleShot(true);
+  connect(&timer, &QTimer::timeout, this, &InputForm::onRefresh);
 }
 
 InputForm::~InputForm()
@@ -22,7 +43,31 @@ InputForm::~InputForm()
 
 void InputForm::onClear()
 {
-  ui->label->setText(QString());
+  pending.clear();
+  pendingChunks = 0;
+  model->clear();
+  store.clear();
+  ui->hexView->clear();
+}
+
+void InputForm::setCodepage(Codepage::Id codepage)
+{
+  delegate->setCodepage(codepage);
+  ui->logView->viewport()->update();
+  ui->hexView->setCodepage(codepage);
+}
+
+void InputForm::setEntryLimit(int limit)
+{
+  model->setLimit(limit);
+  if(limitBox->value() != limit) {
+    limitBox->setValue(limit);
+  }
+}
+
+void InputForm::setRefreshRate(int rate)
+{
+  refreshRate = qBound(1, rate, 1000);
 }
 
 void InputForm::addLogText(Cathegory cathegory, const QString& label, const QByteArray& data) {
@@ -30,27 +75,86 @@ void InputForm::addLogText(Cathegory cathegory, const QString& label, const QByt
   if(elapsed < 0) {
     elapsed = 0;
   }
-  auto time = QTime::currentTime();
+  pending.append(LogEntry{QTime::currentTime(), elapsed, static_cast<LogEntry::Category>(cathegory), label, data});
+  pendingChunks = 0;
+  schedule();
+}
 
-  auto title = QString(
-    "<pre style=\"color: %1;\">%2 (%3ms) %4\n"
-    ).arg(
-        cathegory == Error ? "red" : cathegory == Warning ? "orange" : "navy",
-        time.toString("hh:mm:ss"),
-        QString("%1").arg(elapsed, 6),
-        label
-        );
-  auto text = ui->label->text();
-  text += title;
-  if(!data.isEmpty()) {
-    text += hexDump(data);
+void InputForm::addReceived(const QByteArray& data, double elapsed, int status) {
+  qint64 record = store.append(CaptureStore::Received, data.constData(), data.size(), status);
+  if(pendingChunks) {
+    LogEntry& entry = pending.last();
+    entry.records++;
+    pendingChunks++;
+    pendingBytes += data.size();
+    entry.label = tr("Received(%1) in %2 chunks").arg(QString::number(pendingBytes), QString::number(pendingChunks));
+    return;
+  }
+  QString label = QString("%1(%2)").arg(tr("Received"), QString::number(data.size()));
+  if(elapsed > 0) {
+    label += QString(" %1 ms").arg(QString::number(elapsed * 1e3, 'f', 3));
+  }
+  addLogText(Info, label);
+  pending.last().record = record;
+  pending.last().records = 1;
+  pendingChunks = 1;
+  pendingBytes = data.size();
+}
+
+void InputForm::addSent(const QString& label, const QByteArray& data, int status) {
+  qint64 record = store.append(CaptureStore::Sent, data.constData(), data.size(), status);
+  addLogText(Info, label);
+  pending.last().record = record;
+  pending.last().records = 1;
+}
+
+void InputForm::schedule()
+{
+  if(!timer.isActive()) {
+    timer.start(refreshInterval());
+    scheduleTimer.start();
   }
-  text += "</pre>\n";
-  ui->label->setText(text);
-  timer.start();
 }
 
-void InputForm::onAfterLog()
+/**
+ * Pending entries are inserted at once. If the refresh came late or took
+ * a large part of the frame, the interval is doubled, up to DECIMATION_MAX.
+ */
+void InputForm::onRefresh()
 {
-  ui->scrollArea->verticalScrollBar()->setValue(ui->scrollArea->verticalScrollBar()->maximum());
+  int frame = 1000 / refreshRate;
+  qint64 late = scheduleTimer.elapsed() - timer.interval();
+  QElapsedTimer busy;
+  busy.start();
+  if(!pending.isEmpty()) {
+    model->append(pending);
+    pending.clear();
+    pendingChunks = 0;
+    ui->logView->scrollToBottom();
+  }
+  qint64 load = std::max<qint64>(late, 0) + busy.elapsed();
+  if(load > frame / 2) {
+    decimation = std::min(decimation * 2, static_cast<int>(DECIMATION_MAX));
+  } else if(load < frame / 8 && decimation > 1) {
+    decimation /= 2;
+  }
+  decimationLabel->setText(tr("Display decimated 1/%1").arg(decimation));
+  decimationAction->setVisible(decimation > 1);
+  if(decimation > 1) {
+    schedule(); //Return to full rate when flood is over
+  }
+}
+
+/**
+ * Selected entries are shown whole in hex view.
+ */
+void InputForm::onSelectionChanged()
+{
+  QModelIndexList rows = ui->logView->selectionModel()->selectedRows();
+  std::sort(rows.begin(), rows.end());
+  ui->hexView->clear();
+  for(const QModelIndex& index : rows) {
+    const LogEntry& entry = model->entry(index.row());
+    ui->hexView->append(entry.title(), LogModel::color(entry.category), model->payload(index.row()));
+  }
 }
@@ -4,34 +4,74 @@
 #include <QWidget>
 #include <QElapsedTimer>
 #include <QTimer>
+#include <QVector>
+#include "codepage.h"
+#include "log_model.h"
 
 namespace Ui {
 class InputForm;
 }
 
+class QSpinBox;
+class QLabel;
+class QAction;
 class InputForm : public QWidget
 {
   Q_OBJECT
-  QTimer timer;
+  QTimer timer;               //Refresh of log view
   QElapsedTimer elapsedTimer;
+  QElapsedTimer scheduleTimer; //Since refresh was scheduled
+  CaptureStore store;         //Traffic of log entries, memory is bounded by its limit
+  LogModel *model;
+  LogDelegate *delegate;
+  QSpinBox *limitBox;
+  QLabel *decimationLabel;
+  QAction *decimationAction;
+  QVector<LogEntry> pending;  //Not shown yet
+  int pendingChunks = 0;      //Received chunks merged into last pending entry
+  qint64 pendingBytes = 0;
+  int refreshRate = REFRESH_RATE;
+  int decimation = 1;         //Refresh interval is multiplied when view falls behind
 public:
   enum Cathegory {
-    Info,
-    Warning,
-    Error
+    Info = LogEntry::Info,
+    Warning = LogEntry::Warning,
+    Error = LogEntry::Error
+  };
+  enum {
+    REFRESH_RATE = 10,        //Refreshes per second
+    DECIMATION_MAX = 16
   };
 public:
   explicit InputForm(QWidget *parent = nullptr);
   ~InputForm();
 
   void addLogText(Cathegory cathegory, const QString& label, const QByteArray& data = QByteArray());
+  /**
+   * Received data. Chunks received between refreshes of view are merged into one entry,
+   * elapsed is transfer time in seconds, shown for single chunk.
+   */
+  void addReceived(const QByteArray& data, double elapsed = 0, int status = 0);
+  /**Data written to device, status is 0 or transport error*/
+  void addSent(const QString& label, const QByteArray& data, int status = 0);
+  /**Traffic of log entries, records before first() are released*/
+  const CaptureStore& capture() const {return store;}
+  /**Codepage of text column of data dumps*/
+  void setCodepage(Codepage::Id codepage);
+  /**Entries kept in memory, oldest are removed*/
+  void setEntryLimit(int limit);
+  /**Maximum refreshes of log view per second*/
+  void setRefreshRate(int rate);
 
 protected slots:
   void onClear();
-  void onAfterLog();
+  void onRefresh();
+  void onSelectionChanged();
 
 private:
   Ui::InputForm *ui;
+  void schedule();
+  int refreshInterval() const {return 1000 / refreshRate * decimation;}
 };
 
 #endif // INPUTFORM_H
@@ -0,0 +1,72 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg lockfree_queue
+*/
+/**
+* Lock-free multiple producers / single consumer queue.
+*
+* Intrusive node queue by D.Vyukov: push() is wait-free and may be called
+* from any thread, pop() must be called from one consumer thread only.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 09:12:40<br>
+* @pkgdoc lockfree_queue
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef LOCKFREE_QUEUE_H_1792228360
+#define LOCKFREE_QUEUE_H_1792228360
+/*----------------------------------------------------------------------------*/
+#include <atomic>
+#include <utility>
+/*----------------------------------------------------------------------------*/
+template <class T>
+class LockFreeQueue {
+  struct Node {
+    std::atomic<Node *> next {nullptr};
+    T value;
+  };
+  std::atomic<Node *> head; //Producers side
+  Node *tail;               //Consumer side
+
+public:
+  LockFreeQueue() {
+    Node *stub = new Node;
+    head.store(stub, std::memory_order_relaxed);
+    tail = stub;
+  }
+  ~LockFreeQueue() {
+    T value;
+    while(pop(value)) {
+    }
+    delete tail;
+  }
+  LockFreeQueue(const LockFreeQueue&) = delete;
+  LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+  void push(T value) {
+    Node *node = new Node;
+    node->value = std::move(value);
+    Node *prev = head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  bool pop(T& value) {
+    Node *next = tail->next.load(std::memory_order_acquire);
+    if(next == nullptr) {
+      return false;
+    }
+    value = std::move(next->value);
+    delete tail;
+    tail = next;
+    return true;
+  }
+
+  bool isEmpty() const {
+    return tail->next.load(std::memory_order_acquire) == nullptr;
+  }
+};
+/*----------------------------------------------------------------------------*/
+#endif /*LOCKFREE_QUEUE_H_1792228360*/
+
@@ -0,0 +1,194 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg log_model
+*/
+/**
+* Log entries of input form: list model with limit of entries and delegate.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 23:50:00<br>
+* @pkgdoc log_model
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "log_model.h"
+#include "hex_dump.h"
+#include <QPainter>
+#include <QColor>
+#include <algorithm>
+/*----------------------------------------------------------------------------*/
+QString LogEntry::title() const {
+  return QString("%1 (%2ms) %3").arg(time.toString("hh:mm:ss"), QString("%1").arg(elapsed, 6), label);
+}
+/*----------------------------------------------------------------------------*/
+LogModel::LogModel(CaptureStore *store, QObject *parent) : QAbstractListModel(parent), m_store(store) {
+}
+/*----------------------------------------------------------------------------*/
+int LogModel::rowCount(const QModelIndex& parent) const {
+  return parent.isValid() ? 0 : static_cast<int>(m_entries.size());
+}
+/*----------------------------------------------------------------------------*/
+QVariant LogModel::data(const QModelIndex& index, int role) const {
+  if(!index.isValid() || index.row() >= rowCount()) {
+    return QVariant();
+  }
+  const LogEntry& e = entry(index.row());
+  switch(role) {
+    case Qt::DisplayRole: return e.title();
+    case Qt::ForegroundRole: return color(e.category);
+    case CategoryRole: return static_cast<int>(e.category);
+    case DataRole: return payload(index.row());
+    case PreviewRole: return payload(index.row(), PREVIEW + 1);
+    default: return QVariant();
+  }
+}
+/*----------------------------------------------------------------------------*/
+QByteArray LogModel::payload(int row, qint64 size) const {
+  const LogEntry& e = entry(row);
+  if(e.records && e.record < m_store->first()) {
+    return QByteArray();
+  }
+  if(e.records == 1 && (size < 0 || static_cast<qint64>(m_store->length(e.record)) <= size)) {
+    return m_store->payload(e.record);
+  }
+  if(e.records) {
+    return m_store->copy(e.record, e.records, size);
+  }
+  return size < 0 ? e.data : e.data.left(static_cast<int>(size));
+}
+/*----------------------------------------------------------------------------*/
+void LogModel::append(const QVector<LogEntry>& entries) {
+  if(entries.isEmpty()) {
+    return;
+  }
+  int row = rowCount();
+  beginInsertRows(QModelIndex(), row, row + static_cast<int>(entries.size()) - 1);
+  m_entries.insert(m_entries.end(), entries.begin(), entries.end());
+  endInsertRows();
+  for(const LogEntry& e : entries) {
+    if(e.records) {
+      m_next = e.record + e.records;
+    }
+  }
+  int count = releasedRows();
+  if(rowCount() > m_limit + m_limit / TRIM_PART) {
+    count = std::max(count, rowCount() - m_limit);
+  }
+  trim(count);
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Leading rows up to the last one with records released by store.
+ * Traffic entries are in order of records, so scan stops at first kept one.
+ */
+int LogModel::releasedRows() const {
+  if(m_store->first() == m_released) {
+    return 0;
+  }
+  int count = 0;
+  for(int row = 0; row < rowCount(); row++) {
+    const LogEntry& e = entry(row);
+    if(e.records) {
+      if(e.record >= m_store->first()) {
+        break;
+      }
+      count = row + 1;
+    }
+  }
+  return count;
+}
+/*----------------------------------------------------------------------------*/
+void LogModel::clear() {
+  beginResetModel();
+  m_entries.clear();
+  m_dropped = 0;
+  m_next = 0;
+  m_released = 0;
+  endResetModel();
+}
+/*----------------------------------------------------------------------------*/
+void LogModel::setLimit(int limit) {
+  m_limit = std::max(1, limit);
+  if(rowCount() > m_limit) {
+    trim(rowCount() - m_limit);
+  }
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Records before the first traffic entry left are released in store,
+ * records of pending entries are after m_next.
+ */
+void LogModel::trim(int count) {
+  if(count > 0) {
+    beginRemoveRows(QModelIndex(), 0, count - 1);
+    m_entries.erase(m_entries.begin(), m_entries.begin() + count);
+    m_dropped += count;
+    endRemoveRows();
+    auto traffic = std::find_if(m_entries.begin(), m_entries.end(), [](const LogEntry& e) {return e.records > 0;});
+    m_store->release(traffic != m_entries.end() ? traffic->record : m_next);
+  }
+  m_released = m_store->first();
+}
+/*----------------------------------------------------------------------------*/
+QColor LogModel::color(LogEntry::Category category) {
+  return category == LogEntry::Error ? QColor("red") : category == LogEntry::Warning ? QColor("orange") : QColor("navy");
+}
+/*----------------------------------------------------------------------------*/
+LogDelegate::LogDelegate(QObject *parent) : QStyledItemDelegate(parent) {
+  HexDump::textTable(Codepage::Utf8, m_text);
+}
+/*----------------------------------------------------------------------------*/
+void LogDelegate::setCodepage(Codepage::Id codepage) {
+  HexDump::textTable(codepage, m_text);
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * First line of title, then first PREVIEW bytes as dump row without offset.
+ */
+QString LogDelegate::line(const QModelIndex& index) const {
+  QString text = index.data(Qt::DisplayRole).toString();
+  int feed = text.indexOf('\n');
+  if(feed >= 0) {
+    text.truncate(feed);
+    text += QString::fromUtf8(" \xE2\x80\xA6");
+  }
+  QByteArray data = index.data(LogModel::PreviewRole).toByteArray();
+  if(!data.isEmpty()) {
+    int count = std::min(static_cast<int>(data.size()), static_cast<int>(PREVIEW));
+    ushort buffer[HexDump::lineMax<PREVIEW, PREVIEW>()];
+    ushort *end = HexDump::putRow<PREVIEW, PREVIEW>(buffer, reinterpret_cast<const uchar *>(data.constData()), count, 0, m_text);
+    const int skip = 6; //"0000: "
+    text += "  ";
+    text += QString(reinterpret_cast<const QChar *>(buffer + skip), static_cast<int>(end - buffer - skip - 1));
+    if(data.size() > PREVIEW) {
+      text += QString::fromUtf8("\xE2\x80\xA6");
+    }
+  }
+  return text;
+}
+/*----------------------------------------------------------------------------*/
+void LogDelegate::paint(QPainter *painter, const QStyleOptionViewItem& option, const QModelIndex& index) const {
+  painter->save();
+  bool selected = option.state & QStyle::State_Selected;
+  if(selected) {
+    painter->fillRect(option.rect, option.palette.highlight());
+    painter->setPen(option.palette.highlightedText().color());
+  } else {
+    painter->setPen(index.data(Qt::ForegroundRole).value<QColor>());
+  }
+  painter->setFont(option.font);
+  QRect rect = option.rect.adjusted(MARGIN, 0, -MARGIN, 0);
+  painter->drawText(rect, Qt::AlignLeft | Qt::AlignVCenter | Qt::TextSingleLine, line(index));
+  painter->restore();
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Same for all entries, view uses uniform item sizes.
+ */
+QSize LogDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const {
+  Q_UNUSED(index);
+  QFontMetrics metrics(option.font);
+  return QSize(metrics.horizontalAdvance(QLatin1Char('0')) * 120, metrics.lineSpacing());
+}
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,116 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg log_model
+*/
+/**
+* Log entries of input form: list model with limit of entries and delegate.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 23:50:00<br>
+* @pkgdoc log_model
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef LOG_MODEL_H_1792281000
+#define LOG_MODEL_H_1792281000
+/*----------------------------------------------------------------------------*/
+#include <QAbstractListModel>
+#include <QStyledItemDelegate>
+#include <QByteArray>
+#include <QTime>
+#include <QVector>
+#include <deque>
+#include "codepage.h"
+#include "capture_store.h"
+/*----------------------------------------------------------------------------*/
+struct LogEntry {
+  enum Category {
+    Info,
+    Warning,
+    Error
+  };
+  QTime time;
+  int elapsed;      //ms from previous entry
+  Category category;
+  QString label;
+  QByteArray data;    //Data not in capture store
+  qint64 record = -1; //Traffic: records of capture store
+  int records = 0;
+  /**"hh:mm:ss (    12ms) label", label may have several lines*/
+  QString title() const;
+};
+/*----------------------------------------------------------------------------*/
+/**
+ * Append only list of entries. Oldest entries are removed when count exceeds
+ * limit, by batches of limit / TRIM_PART to keep appending O(1) amortized.
+ * Records of removed entries are released in store, entries whose records
+ * store released by its own limit are removed too.
+ */
+class LogModel : public QAbstractListModel
+{
+  Q_OBJECT
+
+public:
+  enum Role {
+    CategoryRole = Qt::UserRole,
+    DataRole,                     //QByteArray
+    PreviewRole                   //QByteArray, PREVIEW bytes and one more if data is longer
+  };
+  enum {
+    DEFAULT_LIMIT = 10000,
+    TRIM_PART = 8,
+    PREVIEW = 16
+  };
+  /**Payloads of traffic entries are read from store*/
+  explicit LogModel(CaptureStore *store, QObject *parent = nullptr);
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  /**DisplayRole: title, ForegroundRole: color of category*/
+  QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+  const LogEntry& entry(int row) const {return m_entries[static_cast<size_t>(row)];}
+  /**Data of entry, not copied if it is one record of store, empty if records are released*/
+  QByteArray payload(int row, qint64 size = -1) const;
+  /**Entries collected since last refresh of view, inserted at once*/
+  void append(const QVector<LogEntry>& entries);
+  void clear();
+  int limit() const {return m_limit;}
+  void setLimit(int limit);
+  /**Entries removed by limit since clear()*/
+  qint64 dropped() const {return m_dropped;}
+  static QColor color(LogEntry::Category category);
+
+private:
+  CaptureStore *m_store;
+  std::deque<LogEntry> m_entries;
+  int m_limit = DEFAULT_LIMIT;
+  qint64 m_dropped = 0;
+  qint64 m_next = 0;      //Record after those of entries, newer ones are pending
+  qint64 m_released = 0;  //First record of store seen by last append
+  void trim(int count);
+  int releasedRows() const;
+};
+/*----------------------------------------------------------------------------*/
+/**
+ * One line of fixed height per entry: title and dump of first bytes.
+ * Whole data of entry is shown by HexView.
+ */
+class LogDelegate : public QStyledItemDelegate
+{
+  Q_OBJECT
+
+public:
+  explicit LogDelegate(QObject *parent = nullptr);
+  void paint(QPainter *painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+  QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+  void setCodepage(Codepage::Id codepage);
+
+private:
+  enum {
+    PREVIEW = LogModel::PREVIEW,  //Bytes in line
+    MARGIN = 4
+  };
+  ushort m_text[256];
+  QString line(const QModelIndex& index) const;
+};
+/*----------------------------------------------------------------------------*/
+#endif /*LOG_MODEL_H_1792281000*/
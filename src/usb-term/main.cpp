@@ -1,10 +1,61 @@
 #include "mainwindow.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QScopedPointer>
+#include <stdio.h>
+#include <string.h>
+#include "codepage.h"
+#include "headless.h"
+
 int main(int argc, char *argv[])
 {
-  QApplication a(argc, argv);
+  //Command line modes do not need display
+  bool headless = false;
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "--send-file")) {
+      headless = true;
+    }
+  }
+  QScopedPointer<QCoreApplication> app(headless ? new QCoreApplication(argc, argv) : new QApplication(argc, argv));
+
+  QCommandLineParser parser;
+  parser.addHelpOption();
+  QCommandLineOption sendFileOption("send-file", QCoreApplication::translate("main", "Compile and send script <file> without GUI."), "file");
+  parser.addOption(sendFileOption);
+  QCommandLineOption binaryOption("binary", QCoreApplication::translate("main", "Send --send-file as is, without compiling."));
+  parser.addOption(binaryOption);
+  QCommandLineOption noCacheOption("no-cache", QCoreApplication::translate("main", "Compile --send-file script even if it is cached."));
+  parser.addOption(noCacheOption);
+  QCommandLineOption codepageOption("codepage", QCoreApplication::translate("main", "Codepage of --send-file script strings: utf8, cp437, cp866 or cp1251."), "name", "utf8");
+  parser.addOption(codepageOption);
+  QCommandLineOption connectOption("connect", QCoreApplication::translate("main", "Connection for --send-file: usb:VID:PID[,read-queue=N,read-packets=N,write-queue=N,write-chunk=BYTES,zlp=0|1], tcp:HOST[:PORT], dev:PATH or virtual[:KB/s]."), "connection");
+  parser.addOption(connectOption);
+  QCommandLineOption timeoutOption("timeout", QCoreApplication::translate("main", "Fail --send-file when device is detached or accepts no data for <seconds>, 0 waits forever."), "seconds", "30");
+  parser.addOption(timeoutOption);
+  parser.process(*app);
+
+  if(parser.isSet(sendFileOption)) {
+    if(!parser.isSet(connectOption)) {
+      fprintf(stderr, "--connect is required with --send-file\n");
+      return 1;
+    }
+    Codepage::Id codepage;
+    if(!Codepage::fromName(parser.value(codepageOption), &codepage)) {
+      fprintf(stderr, "Unknown codepage %s\n", qPrintable(parser.value(codepageOption)));
+      return 1;
+    }
+    bool ok = false;
+    int timeout = parser.value(timeoutOption).toInt(&ok);
+    if(!ok || timeout < 0) {
+      fprintf(stderr, "Bad timeout %s\n", qPrintable(parser.value(timeoutOption)));
+      return 1;
+    }
+    return sendFileHeadless(parser.value(sendFileOption), parser.value(connectOption), parser.isSet(binaryOption), !parser.isSet(noCacheOption),
+                            codepage, timeout);
+  }
+
   MainWindow w;
   w.show();
-  return a.exec();
+  return app->exec();
 }
@@ -5,17 +5,36 @@
 #include <QMessageBox>
 #include <QCloseEvent>
 #include <QFileInfo>
+#include <QFile>
+#include <QActionGroup>
 #include "connectiondialog.h"
 #include "usbcon.h"
+#include "chardev_transport.h"
+#include "pty_transport.h"
 #include "inputform.h"
 #include "text_parser.h"
+#include "send_file.h"
+
+//Bigger data is expanded by chunks while sending and not dumped to log
+static const int LOG_DATA_LIMIT = 64 * 1024;
 
 MainWindow::MainWindow(QWidget *parent)
   : QMainWindow(parent)
   , ui(new Ui::MainWindow)
 {
   ui->setupUi(this);
-  connection = new UsbConnection();
+
+  //Codepage of the active tab: its script strings and text column of log dumps
+  auto codepageMenu = ui->menubar->addMenu(tr("Code&page"));
+  codepageGroup = new QActionGroup(this);
+  for(int i = 0; i < Codepage::COUNT; i++) {
+    auto action = codepageMenu->addAction(QString(Codepage::name(static_cast<Codepage::Id>(i))).toUpper());
+    action->setCheckable(true);
+    action->setData(i);
+    codepageGroup->addAction(action);
+  }
+  connect(codepageGroup, &QActionGroup::triggered, this, &MainWindow::onCodepage);
+
   onFileNew();
   ui->tabWidget->setTabsClosable(true);
   connect(ui->tabWidget, &QTabWidget::tabCloseRequested, this, &MainWindow::onTabCloseRequest);
@@ -23,12 +42,13 @@ MainWindow::MainWindow(QWidget *parent)
   timer = new QTimer();
   timer->setSingleShot(false);
   connect(timer, &QTimer::timeout, this, &MainWindow::onTimer);
-  timer->setInterval(20);
+  timer->setInterval(100);
   timer->start();
 }
 
 MainWindow::~MainWindow()
 {
+  stopFileSender();
   delete timer;
   delete connection;
   delete ui;
@@ -191,29 +211,116 @@ void MainWindow::onExit()
 void MainWindow::onConnectionOpen()
 {
   ConnectionDialog dialog(this);
+  dialog.setType(static_cast<ConnectionDialog::Type>(connectionType));
+  dialog.setAttachScript(attachScriptFile);
+  dialog.setVirtualSettings(virtualSettings);
+  dialog.setDeviceFile(deviceFile);
+  dialog.setTcpSettings(tcpSettings);
+  dialog.setUsbSettings(usbSettings);
   if(dialog.exec() == QDialog::Accepted) {
-    auto vid = dialog.vid();
-    auto pid = dialog.pid();
-    if(!connection->open(vid, pid)) {
+    connectionType = dialog.type();
+    attachScriptFile = dialog.attachScript();
+    virtualSettings = dialog.virtualSettings();
+    deviceFile = dialog.deviceFile();
+    tcpSettings = dialog.tcpSettings();
+    usbSettings = dialog.usbSettings();
+
+    stopFileSender();
+    delete connection;
+    connection = nullptr;
+    if(connectionType == ConnectionDialog::Virtual) {
+      auto con = new VirtualTransport();
+      connection = con;
+      setConnectionNotify();
+      con->open(virtualSettings);
+    } else if(connectionType == ConnectionDialog::CharDevice) {
+      auto con = new CharDeviceTransport();
+      connection = con;
+      setConnectionNotify();
+      con->open(deviceFile.toStdString());
+    } else if(connectionType == ConnectionDialog::Tcp) {
+      auto con = new TcpTransport();
+      connection = con;
+      setConnectionNotify();
+      con->open(tcpSettings);
+    } else if(connectionType == ConnectionDialog::Pty) {
+      auto con = new PtyTransport();
+      connection = con;
+      setConnectionNotify();
+      con->open();
+    } else {
+      QByteArray script;
+      if(!attachScriptFile.isEmpty()) {
+        QFile file(attachScriptFile);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+          QMessageBox::critical(this, tr("Error open file"), file.errorString());
+          return;
+        }
+        script = parseText(QString::fromUtf8(file.readAll()));
+      }
+      auto con = new UsbConnection();
+      connection = con;
+      setConnectionNotify();
+      con->setSettings(usbSettings);
+      con->setAttachScript(std::vector<uint8_t>(script.begin(), script.end()));
+      con->open(dialog.vid(), dialog.pid());
+    }
+    if(!connection->isOpened()) {
       QMessageBox::critical(this, tr("Error open connection"), QString::fromStdString(connection->message()));
+      delete connection;
+      connection = nullptr;
       return;
     }
+    ui->inputForm->addLogText(InputForm::Info, tr("Connected to %1").arg(QString::fromStdString(connection->name())));
     ui->actionConnectionOpen->setEnabled(false);
     ui->actionConnectionClose->setEnabled(true);
     ui->actionSendData->setEnabled(true);
+    ui->actionSendFile->setEnabled(true);
+    ui->actionSendBinary->setEnabled(true);
     ui->actionTest->setEnabled(false);
   }
 }
 
+void MainWindow::setConnectionNotify()
+{
+  //Called from transport I/O thread: deliver events to GUI thread
+  connection->setNotify([this]() {
+    QMetaObject::invokeMethod(this, "onTimer", Qt::QueuedConnection);
+  });
+}
+
 void MainWindow::onConnectionSend()
 {
   auto form = activeForm();
   if(!form) {
     return;
   }
-  auto data = parseText(form->text());
-  ui->inputForm->addLogText(InputForm::Info, QString("%1(%2)").arg(tr("Sent"), QString::number(data.size())), data);
+  if(!connection) {
+    return;
+  }
+  auto script = form->compiledScript();
+  quint64 size = script.size();
+  if(size > LOG_DATA_LIMIT || script.hasCommands()) {
+    //Commands are executed by sender thread
+    if(fileSender) {
+      return;
+    }
+    auto sender = new ScriptDataSender(connection);
+    sender->start(script);
+    fileSender = sender;
+    fileSendTimer.start();
+    setSending(true);
+    QString label = QString("%1(%2)").arg(tr("Sent"), QString::number(size));
+    if(size <= LOG_DATA_LIMIT) {
+      ui->inputForm->addSent(label, script.toByteArray());
+    } else {
+      ui->inputForm->addLogText(InputForm::Info, label);
+    }
+    return;
+  }
+  auto data = script.toByteArray();
   connection->write(data.data(), data.size());
+  ui->inputForm->addSent(QString("%1(%2)").arg(tr("Sent"), QString::number(data.size())), data, connection->isError() ? -1 : 0);
   if(connection->isError()) {
     ui->inputForm->addLogText(InputForm::Error, QString::fromStdString(connection->message()));
   }
@@ -221,10 +328,15 @@ void MainWindow::onConnectionSend()
 
 void MainWindow::onConnectionClose()
 {
-  connection->close();
+  stopFileSender();
+  if(connection) {
+    connection->close();
+  }
   ui->actionConnectionOpen->setEnabled(true);
   ui->actionConnectionClose->setEnabled(false);
   ui->actionSendData->setEnabled(false);
+  ui->actionSendFile->setEnabled(false);
+  ui->actionSendBinary->setEnabled(false);
   ui->actionTest->setEnabled(true);
 }
 
@@ -234,7 +346,19 @@ void MainWindow::onTabChanged()
   if(!form) {
     return;
   }
-  int index = ui->tabWidget->currentIndex();
+  updateTabTitle(ui->tabWidget->currentIndex());
+  if(codepageGroup) {
+    codepageGroup->actions().at(form->codepage())->setChecked(true);
+  }
+  ui->inputForm->setCodepage(form->codepage());
+}
+
+void MainWindow::updateTabTitle(int index)
+{
+  OutputForm *form = qobject_cast<OutputForm *>(ui->tabWidget->widget(index));
+  if(!form) {
+    return;
+  }
   auto fileName = form->fileName();
   if(fileName.isEmpty()) {
     fileName = tr("unknown");
@@ -244,12 +368,30 @@ void MainWindow::onTabChanged()
   }
   bool modified = form->isModified();
   ui->tabWidget->setTabText(index, fileName + QString(modified ? " *" : ""));
-  ui->actionSave->setEnabled(modified);
+  if(index == ui->tabWidget->currentIndex()) {
+    ui->actionSave->setEnabled(modified);
+  }
+}
+
+void MainWindow::onCodepage(QAction *action)
+{
+  auto form = activeForm();
+  if(!form) {
+    return;
+  }
+  auto codepage = static_cast<Codepage::Id>(action->data().toInt());
+  form->setCodepage(codepage);
+  ui->inputForm->setCodepage(codepage);
 }
 
 void MainWindow::onFileChanged()
 {
-  onTabChanged(); //TODO !!!
+  //Queued: sender may be other than current tab or closed already
+  for(int i = 0; i < ui->tabWidget->count(); i++) {
+    if(ui->tabWidget->widget(i) == sender()) {
+      updateTabTitle(i);
+    }
+  }
 }
 
 void MainWindow::onTabCloseRequest(int index)
@@ -263,13 +405,43 @@ void MainWindow::onTabCloseRequest(int index)
 
 void MainWindow :: onTimer()
 {
-  if(connection->isOpened()) {
-    char buffer[1024];
-    int size = connection->read(buffer, sizeof(buffer), 10);
-    if(size > 0) {
-      ui->inputForm->addLogText(InputForm::Info, QString("%1(%2)").arg(tr("Received"), QString::number(size)), QByteArray(buffer, size));
+  updateFileSender();
+  if(connection && connection->isOpened()) {
+    TransportEvent event;
+    while(connection->poll(&event)) {
+      switch(event.type) {
+        case TransportEvent::Received: {
+          QByteArray data(reinterpret_cast<const char *>(event.data.data()), event.data.size());
+          ui->inputForm->addReceived(data, event.elapsed, event.status);
+          break;
+        }
+        case TransportEvent::Progress:
+          ui->statusbar->showMessage(tr("Sent %1 of %2 bytes, %3 MB/s").arg(
+                                       QString::number(event.length),
+                                       QString::number(event.total),
+                                       QString::number(event.rate / 1e6, 'f', 3)));
+          break;
+        case TransportEvent::Written:
+          ui->statusbar->showMessage(tr("Sent %1 bytes, %2 MB/s %3").arg(
+                                       QString::number(event.length),
+                                       QString::number(event.rate / 1e6, 'f', 3),
+                                       QString::fromStdString(event.message)), 5000);
+          break;
+        case TransportEvent::Detached:
+          ui->inputForm->addLogText(InputForm::Warning, QString::fromStdString(event.message));
+          break;
+        case TransportEvent::Attached:
+          ui->inputForm->addLogText(InputForm::Info, QString::fromStdString(event.message));
+          break;
+        case TransportEvent::Recovery:
+          ui->inputForm->addLogText(InputForm::Warning, QString::fromStdString(event.message));
+          break;
+        case TransportEvent::Error:
+          ui->inputForm->addLogText(InputForm::Error, QString::fromStdString(event.message));
+          break;
+      }
     }
-    if(size < 0) {
+    if(connection->isError()) {
       ui->inputForm->addLogText(InputForm::Error, QString::fromStdString(connection->message()));
     }
   }
@@ -281,7 +453,119 @@ void MainWindow :: onTest()
   if(!form) {
     return;
   }
-  auto data = parseText(form->text());
-  ui->inputForm->addLogText(InputForm::Warning, QString("%1(%2)").arg(tr("Test"), QString::number(data.size())), data);
+  auto script = form->compiledScript();
+  ui->inputForm->addLogText(InputForm::Warning, QString("%1(%2)").arg(tr("Test"), QString::number(script.size())),
+                            script.toByteArray(LOG_DATA_LIMIT));
+
+}
+
+void MainWindow :: onSendFile()
+{
+  if(!connection || fileSender) {
+    return;
+  }
+  auto fileName = QFileDialog::getOpenFileName(this,
+                                               tr("Send file"), "",
+                                               tr("Text files (*.txt);;All files(*.*)"));
+  if(fileName.isEmpty()) {
+    return;
+  }
+  auto sender = new ScriptFileSender(connection);
+  auto form = activeForm();
+  if(form) {
+    sender->setCodepage(form->codepage());
+  }
+  startFileSender(sender, fileName);
+}
+
+void MainWindow :: onSendBinary()
+{
+  if(!connection || fileSender) {
+    return;
+  }
+  auto fileName = QFileDialog::getOpenFileName(this,
+                                               tr("Send binary file"), "",
+                                               tr("All files(*.*)"));
+  if(fileName.isEmpty()) {
+    return;
+  }
+  startFileSender(new BinaryFileSender(connection), fileName);
+}
+
+void MainWindow :: onCancelSend()
+{
+  if(!fileSender) {
+    return;
+  }
+  //Data already queued to transport is not recalled
+  fileSender->cancel();
+  ui->inputForm->addLogText(InputForm::Warning, tr("Send cancelled, %1 of %2 bytes queued").arg(
+                              QString::number(fileSender->sent()),
+                              QString::number(fileSender->fileSize())));
+  stopFileSender();
+}
+
+void MainWindow :: startFileSender(FileSender *sender, const QString& fileName)
+{
+  fileSender = sender;
+  if(!fileSender->start(fileName)) {
+    QMessageBox::critical(this, tr("Error open file"), fileSender->message());
+    delete fileSender;
+    fileSender = nullptr;
+    return;
+  }
+  fileSendTimer.start();
+  setSending(true);
+  ui->inputForm->addLogText(InputForm::Info, tr("Sending file %1 (%2 bytes)").arg(fileName, QString::number(fileSender->fileSize())));
+}
+
+void MainWindow :: updateFileSender()
+{
+  if(!fileSender) {
+    return;
+  }
+  qint64 pending = static_cast<qint64>(connection->pendingBytes());
+  qint64 written = fileSender->sent() - pending;
+  double sec = fileSendTimer.nsecsElapsed() / 1e9;
+  if(!fileSender->isFinished() || (!fileSender->isError() && pending > 0)) {
+    //Progress is counted by bytes accepted by device, not by queued ones
+    ui->statusbar->showMessage(tr("Sent %1 of %2 bytes, %3 MB/s").arg(
+                                 QString::number(written),
+                                 QString::number(fileSender->fileSize()),
+                                 QString::number(sec > 0 ? written / 1e6 / sec : 0, 'f', 3)));
+    return;
+  }
+  if(fileSender->isCached()) {
+    ui->inputForm->addLogText(InputForm::Info, tr("Compiled script loaded from cache"));
+  }
+  QString timing = fileSender->timingReport();
+  if(!timing.isEmpty()) {
+    ui->inputForm->addLogText(InputForm::Info, tr("Timing:\n%1").arg(timing));
+  }
+  if(fileSender->isError()) {
+    ui->inputForm->addLogText(InputForm::Error, tr("Send: %1").arg(fileSender->message()));
+  } else {
+    ui->inputForm->addLogText(InputForm::Info, tr("Sent %1 bytes in %2 s, %3 MB/s").arg(
+                                QString::number(fileSender->sent()),
+                                QString::number(sec, 'f', 3),
+                                QString::number(sec > 0 ? fileSender->sent() / 1e6 / sec : 0, 'f', 3)));
+  }
+  ui->statusbar->clearMessage();
+  stopFileSender();
+}
 
+void MainWindow :: stopFileSender()
+{
+  //Sender thread writes to connection: stop it before connection is closed
+  delete fileSender;
+  fileSender = nullptr;
+  setSending(false);
+}
+
+void MainWindow :: setSending(bool sending)
+{
+  bool opened = connection && connection->isOpened();
+  ui->actionSendFile->setEnabled(opened && !sending);
+  ui->actionSendBinary->setEnabled(opened && !sending);
+  ui->actionCancelSend->setEnabled(sending);
 }
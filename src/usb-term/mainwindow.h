@@ -3,21 +3,43 @@
 
 #include <QMainWindow>
 #include <QTimer>
+#include <QElapsedTimer>
+#include "virtual_transport.h"
+#include "tcp_transport.h"
+#include "usbcon.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
 
 class OutputForm;
-class UsbConnection;
+class Transport;
+class FileSender;
+class QAction;
+class QActionGroup;
 class MainWindow : public QMainWindow
 {
   Q_OBJECT
 
   QTimer *timer;
-  UsbConnection *connection;
+  Transport *connection = nullptr;
+  FileSender *fileSender = nullptr;
+  QElapsedTimer fileSendTimer;
+  QActionGroup *codepageGroup = nullptr;
+  int connectionType = 0;
+  QString attachScriptFile;
+  VirtualDeviceSettings virtualSettings;
+  QString deviceFile;
+  TcpSettings tcpSettings;
+  UsbSettings usbSettings;
   OutputForm *activeForm();
+  void updateTabTitle(int index);
   bool modifiedQuestion(OutputForm *form);
+  void setConnectionNotify();
+  void startFileSender(FileSender *sender, const QString& fileName);
+  void stopFileSender();
+  void setSending(bool sending);
+  void updateFileSender();
   void closeEvent(QCloseEvent *e) override;
 
 
@@ -40,6 +62,10 @@ protected slots:
   void onTabCloseRequest(int index);
   void onTimer();
   void onTest();
+  void onSendFile();
+  void onSendBinary();
+  void onCancelSend();
+  void onCodepage(QAction *action);
 
 private:
   Ui::MainWindow *ui;
@@ -27,6 +27,18 @@ QString OutputForm::text() {
   return ui->edit->toPlainText();
 }
 
+CompiledScript OutputForm::compiledScript() {
+  return textHighlighter->compiledScript();
+}
+
+Codepage::Id OutputForm::codepage() const {
+  return textHighlighter->codepage();
+}
+
+void OutputForm::setCodepage(Codepage::Id codepage) {
+  textHighlighter->setCodepage(codepage);
+}
+
 void OutputForm::loadFile(const QString& f)
 {
   QFile file(f);
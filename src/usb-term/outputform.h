@@ -2,6 +2,7 @@
 #define OUTPUTFORM_H
 
 #include <QWidget>
+#include "codepage.h"
 
 
 namespace Ui {
@@ -9,6 +10,7 @@ class OutputForm;
 }
 
 class TextHighlighter;
+class CompiledScript;
 class OutputForm : public QWidget
 {
   Q_OBJECT
@@ -22,6 +24,11 @@ public:
   void setFileName(const QString& f) {m_fileName = f; emit fileNameChanged(f);}
   bool isModified() const;
   QString text();
+  /**Script to send, compiled per text block while editing*/
+  CompiledScript compiledScript();
+  /**Codepage of script strings in this tab, until @codepage*/
+  Codepage::Id codepage() const;
+  void setCodepage(Codepage::Id codepage);
 
 public slots:
   void loadFile(const QString& f);
@@ -0,0 +1,428 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg poll_transport
+*/
+/**
+* Base of file descriptor transports driven by poll().
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 14:02:47<br>
+* @pkgdoc poll_transport
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "poll_transport.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <chrono>
+/*----------------------------------------------------------------------------*/
+typedef std::chrono::steady_clock Clock;
+/*----------------------------------------------------------------------------*/
+struct PollJob {
+  TransportBuffer data;
+  size_t accepted = 0;
+  Clock::time_point started;
+  Clock::time_point reported;
+};
+/*----------------------------------------------------------------------------*/
+class PollTransportPrivate {
+public:
+  enum {
+    READ_SIZE = 65536,
+    WRITE_SIZE = 65536,
+    PROGRESS_INTERVAL_MS = 100,
+    REOPEN_INTERVAL_MS = 500
+  };
+  PollTransport *owner;
+  int fd = -1;
+  bool connecting = false;  //fd is connecting until open_deadline
+  Clock::time_point open_deadline;
+  int wake_fd[2] = {-1, -1};
+  std::thread thread;
+  std::mutex mutex;
+  std::atomic<bool> running {false};
+  std::deque<PollJob> jobs;
+  std::atomic<size_t> queued_bytes {0};
+  Clock::time_point detached;
+  TransportEventQueue events;
+  std::vector<uint8_t> read_buffer;
+  //--------------------------------------
+  PollTransportPrivate(PollTransport *o) : owner(o) {}
+  //--------------------------------------
+  ~PollTransportPrivate() {
+    if(fd >= 0) {
+      ::close(fd);
+    }
+    for(int i = 0; i < 2; i++) {
+      if(wake_fd[i] >= 0) {
+        ::close(wake_fd[i]);
+      }
+    }
+  }
+  //--------------------------------------
+  /**Returns 0, EINPROGRESS if fd is connecting or errno value*/
+  int openDevice() {
+    fd = -1;
+    connecting = false;
+    int err = owner->openDevice(&fd);
+    if(err == EINPROGRESS && fd >= 0) {
+      connecting = true;
+      open_deadline = Clock::now() + std::chrono::milliseconds(PollTransport::OPEN_TIMEOUT_MS);
+      return err;
+    }
+    if(err && fd >= 0) {
+      ::close(fd);
+      fd = -1;
+    }
+    return err;
+  }
+  //--------------------------------------
+  /**Connection in progress is writable or timed out*/
+  int finishOpen(bool timeout) {
+    connecting = false;
+    int err = timeout ? ETIMEDOUT : owner->openResult(fd);
+    if(err) {
+      ::close(fd);
+      fd = -1;
+    }
+    return err;
+  }
+  //--------------------------------------
+  /**First connection is waited for, so open() reports unreachable peer*/
+  int waitOpen() {
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    int r;
+    do {
+      r = ::poll(&pfd, 1, PollTransport::OPEN_TIMEOUT_MS);
+    } while(r < 0 && errno == EINTR);
+    if(r < 0) {
+      int err = errno;
+      connecting = false;
+      ::close(fd);
+      fd = -1;
+      return err;
+    }
+    return finishOpen(r == 0);
+  }
+  //--------------------------------------
+  int start() {
+    int err = 0;
+    for(int i = 0; i < owner->openAttempts(); i++) {
+      err = openDevice();
+      if(err == EINPROGRESS) {
+        err = waitOpen();
+      }
+      if(!err) {
+        break;
+      }
+    }
+    if(err) {
+      return err;
+    }
+    if(::pipe(wake_fd) < 0) {
+      return errno;
+    }
+    fcntl(wake_fd[0], F_SETFL, O_NONBLOCK);
+    fcntl(wake_fd[1], F_SETFL, O_NONBLOCK);
+    read_buffer.resize(READ_SIZE);
+    running = true;
+    thread = std::thread(&PollTransportPrivate::run, this);
+    return 0;
+  }
+  //--------------------------------------
+  void stop() {
+    running = false;
+    wakeup();
+    if(thread.joinable()) {
+      thread.join();
+    }
+  }
+  //--------------------------------------
+  void wakeup() {
+    char c = 0;
+    if(::write(wake_fd[1], &c, 1) < 0) {
+      //Pipe is full: thread is woken up anyway
+    }
+  }
+  //--------------------------------------
+  void write(const TransportBuffer& buffer) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      PollJob job;
+      job.data = buffer;
+      jobs.push_back(std::move(job));
+      queued_bytes += buffer.size;
+    }
+    wakeup();
+  }
+  //--------------------------------------
+  void postEvent(TransportEvent::Type type, int status, const std::string& message) {
+    TransportEvent event;
+    event.type = type;
+    event.status = status;
+    event.message = message;
+    events.post(std::move(event));
+  }
+  //--------------------------------------
+  static double rate(const PollJob& job, Clock::time_point now) {
+    double sec = std::chrono::duration<double>(now - job.started).count();
+    return sec > 0 ? job.accepted / sec : 0;
+  }
+  //--------------------------------------
+  /**Device node is gone (usblp unplugged) or peer closed connection*/
+  static bool isLost(int err) {
+    return err == ENODEV || err == ENXIO || err == EIO || err == EPIPE
+      || err == ECONNRESET || err == ETIMEDOUT;
+  }
+  //--------------------------------------
+  void detach(int err) {
+    ::close(fd);
+    fd = -1;
+    detached = Clock::now();
+    postEvent(TransportEvent::Detached, err, owner->name() + ": " + strerror(err) + ", waiting for device");
+  }
+  //--------------------------------------
+  void reattach() {
+    if(!openDevice()) {
+      attached();
+    }
+    //EINPROGRESS: run() waits for connection
+  }
+  //--------------------------------------
+  void attached() {
+    TransportEvent event;
+    event.type = TransportEvent::Attached;
+    event.elapsed = std::chrono::duration<double>(Clock::now() - detached).count();
+    char buffer[128];
+    snprintf(buffer, sizeof(buffer), ": reopened in %.3f s", event.elapsed);
+    event.message = owner->name() + buffer;
+    events.post(std::move(event));
+  }
+  //--------------------------------------
+  bool hasJobs() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !jobs.empty();
+  }
+  //--------------------------------------
+  void readDevice() {
+    for(;;) {
+      ssize_t r = ::read(fd, read_buffer.data(), read_buffer.size());
+      if(r > 0) {
+        TransportEvent event;
+        event.type = TransportEvent::Received;
+        event.length = r;
+        event.data.assign(read_buffer.begin(), read_buffer.begin() + r);
+        events.post(std::move(event));
+        continue;
+      }
+      if(r < 0 && errno == EINTR) {
+        continue;
+      }
+      if(r == 0) {
+        //End of file: TCP peer closed connection, pty hung up
+        detach(ECONNRESET);
+      } else if(isLost(errno)) {
+        detach(errno);
+      }
+      //EAGAIN: wait for next POLLIN
+      return;
+    }
+  }
+  //--------------------------------------
+  void writeDevice() {
+    std::lock_guard<std::mutex> lock(mutex);
+    while(!jobs.empty()) {
+      PollJob& job = jobs.front();
+      auto now = Clock::now();
+      if(job.started == Clock::time_point()) {
+        job.started = job.reported = now;
+      }
+      size_t n = job.data.size - job.accepted;
+      if(n > WRITE_SIZE) {
+        n = WRITE_SIZE;
+      }
+      ssize_t r = n ? ::write(fd, job.data.data + job.accepted, n) : 0;
+      if(r < 0) {
+        int err = errno;
+        if(err == EINTR) {
+          continue;
+        }
+        if(err == EAGAIN || err == EWOULDBLOCK) {
+          return; //Device is busy: wait for POLLOUT
+        }
+        if(isLost(err)) {
+          //Keep the job: rest of data is sent after reopen
+          detach(err);
+          return;
+        }
+        queued_bytes -= job.data.size - job.accepted;
+        jobs.pop_front();
+        postEvent(TransportEvent::Error, err, owner->name() + ": write error: " + strerror(err));
+        continue;
+      }
+      job.accepted += r;
+      queued_bytes -= r;
+      now = Clock::now();
+      TransportEvent event;
+      event.length = job.accepted;
+      event.total = job.data.size;
+      event.rate = rate(job, now);
+      if(job.accepted >= job.data.size) {
+        event.type = TransportEvent::Written;
+        event.message = owner->statistics(fd);
+        events.post(std::move(event));
+        jobs.pop_front();
+      } else if(now - job.reported >= std::chrono::milliseconds(PROGRESS_INTERVAL_MS)) {
+        job.reported = now;
+        event.type = TransportEvent::Progress;
+        events.post(std::move(event));
+      }
+    }
+  }
+  //--------------------------------------
+  void run() {
+    while(running) {
+      struct pollfd fds[2];
+      int nfds = 1;
+      fds[0].fd = wake_fd[0];
+      fds[0].events = POLLIN;
+      fds[0].revents = 0;
+      int timeout = fd >= 0 ? -1 : REOPEN_INTERVAL_MS;
+      if(fd >= 0) {
+        fds[1].fd = fd;
+        fds[1].events = connecting ? POLLOUT : POLLIN | (hasJobs() ? POLLOUT : 0);
+        fds[1].revents = 0;
+        nfds = 2;
+      }
+      if(connecting) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(open_deadline - Clock::now()).count();
+        timeout = left > 0 ? static_cast<int>(left) + 1 : 0;
+      }
+
+      int r = ::poll(fds, nfds, timeout);
+      if(r < 0 && errno != EINTR) {
+        postEvent(TransportEvent::Error, errno, std::string("poll: ") + strerror(errno));
+        return;
+      }
+      if(fds[0].revents & POLLIN) {
+        char buffer[64];
+        while(::read(wake_fd[0], buffer, sizeof(buffer)) > 0) {
+        }
+      }
+      if(!running) {
+        break;
+      }
+      if(fd < 0) {
+        reattach();
+        continue;
+      }
+      short revents = fds[1].revents;
+      if(connecting) {
+        if((revents || Clock::now() >= open_deadline) && !finishOpen(!revents)) {
+          attached();
+        }
+        continue;
+      }
+      if(revents & POLLNVAL) {
+        detach(EBADF);
+        continue;
+      }
+      if(revents & (POLLIN | POLLHUP | POLLERR)) {
+        readDevice();
+      }
+      if(fd >= 0 && (revents & (POLLOUT | POLLERR))) {
+        writeDevice();
+      }
+      if(fd >= 0 && (revents & POLLHUP)) {
+        //Peer closed (pty master, TCP FIN, usblp disconnect), input is drained already
+        detach(ENXIO);
+      }
+    }
+  }
+};
+/*----------------------------------------------------------------------------*/
+PollTransport :: ~PollTransport()
+{
+  close();
+}
+/*----------------------------------------------------------------------------*/
+bool PollTransport :: start()
+{
+  close();
+  m_message.clear();
+  m_error = 0;
+  auto p = new PollTransportPrivate(this);
+  p->events.setNotify(m_notify);
+  p->events.setMonitor(m_monitor);
+  int err = p->start();
+  if(err) {
+    m_error = -err;
+    m_message = name() + ": " + strerror(err);
+    delete p;
+    return false;
+  }
+  d = p;
+  return true;
+}
+/*----------------------------------------------------------------------------*/
+void PollTransport :: close()
+{
+  if(d) {
+    d->stop();
+    delete d;
+    d = nullptr;
+  }
+}
+/*----------------------------------------------------------------------------*/
+int PollTransport :: write(const void *buffer, size_t size)
+{
+  if(!d) {
+    m_error = -1;
+    m_message = "Not opened";
+    return -1;
+  }
+  m_message.clear();
+  m_error = 0;
+  if(size > 0) {
+    d->write(TransportBuffer::copy(buffer, size));
+  }
+  return size;
+}
+/*----------------------------------------------------------------------------*/
+int PollTransport :: writeBuffer(const TransportBuffer& buffer)
+{
+  if(!d) {
+    m_error = -1;
+    m_message = "Not opened";
+    return -1;
+  }
+  m_message.clear();
+  m_error = 0;
+  if(buffer.size > 0) {
+    d->write(buffer);
+  }
+  return buffer.size;
+}
+/*----------------------------------------------------------------------------*/
+bool PollTransport :: poll(TransportEvent *event)
+{
+  return d ? d->events.pop(event) : false;
+}
+/*----------------------------------------------------------------------------*/
+size_t PollTransport :: pendingBytes() const
+{
+  return d ? d->queued_bytes.load() : 0;
+}
+/*----------------------------------------------------------------------------*/
+
@@ -0,0 +1,60 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg poll_transport
+*/
+/**
+* Base of file descriptor transports driven by poll().
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 14:02:47<br>
+* @pkgdoc poll_transport
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef POLL_TRANSPORT_H_1792245767
+#define POLL_TRANSPORT_H_1792245767
+/*----------------------------------------------------------------------------*/
+#include "transport.h"
+/*----------------------------------------------------------------------------*/
+class PollTransportPrivate;
+/**
+ * Transport over non blocking file descriptor.
+ * I/O thread waits for descriptor with poll(). If descriptor is lost
+ * (device unplugged, peer closed connection), it is reopened with openDevice()
+ * and unsent data is sent after reopen. Connection in progress is waited
+ * for in the same poll(), so close() and writes are not delayed by reopen.
+ */
+class PollTransport : public Transport {
+  friend class PollTransportPrivate;
+protected:
+  PollTransportPrivate *d = nullptr;
+  /**
+   * Open non blocking descriptor. Returns 0 or errno value, EINPROGRESS if
+   * descriptor is connecting: openResult() is called when it is writable.
+   * Called from I/O thread on reopen.
+   */
+  virtual int openDevice(int *fd) = 0;
+  /**Result of connection in progress, 0 or errno value*/
+  virtual int openResult(int /*fd*/) {return 0;}
+  /**Calls of openDevice() tried by first open if connection fails, one per peer address*/
+  virtual int openAttempts() const {return 1;}
+  /**Connection statistics appended to write completion message*/
+  virtual std::string statistics(int /*fd*/) const {return std::string();}
+  /**Open descriptor and start I/O thread*/
+  bool start();
+public:
+  enum {
+    OPEN_TIMEOUT_MS = 2000    //Connection in progress
+  };
+  ~PollTransport();
+  void close() override;
+
+  int write(const void *buffer, size_t size) override;
+  int writeBuffer(const TransportBuffer& buffer) override;
+  bool poll(TransportEvent *event) override;
+  size_t pendingBytes() const override;
+  bool isOpened() const override {return d != nullptr;}
+};
+/*----------------------------------------------------------------------------*/
+#endif /*POLL_TRANSPORT_H_1792245767*/
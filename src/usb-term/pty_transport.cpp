@@ -0,0 +1,65 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg pty_transport
+*/
+/**
+* Pseudo terminal transport: other programs connect to the slave side.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 14:48:21<br>
+* @pkgdoc pty_transport
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "pty_transport.h"
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+/*----------------------------------------------------------------------------*/
+bool PtyTransport :: open()
+{
+  close();
+  return start();
+}
+/*----------------------------------------------------------------------------*/
+void PtyTransport :: close()
+{
+  PollTransport::close();
+  if(m_slave >= 0) {
+    ::close(m_slave);
+    m_slave = -1;
+  }
+}
+/*----------------------------------------------------------------------------*/
+int PtyTransport :: openDevice(int *fd)
+{
+  if(m_slave >= 0) {
+    //Master is never lost while slave is held: pty can not be recreated with same name
+    return ENXIO;
+  }
+  *fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+  if(*fd < 0 || grantpt(*fd) < 0 || unlockpt(*fd) < 0) {
+    return errno;
+  }
+  const char *name = ptsname(*fd);
+  if(!name) {
+    return errno;
+  }
+  //Binary data must pass as is: no echo, no line discipline
+  struct termios tio;
+  if(tcgetattr(*fd, &tio) == 0) {
+    cfmakeraw(&tio);
+    tcsetattr(*fd, TCSANOW, &tio);
+  }
+  m_slave = ::open(name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+  if(m_slave < 0) {
+    return errno;
+  }
+  m_slaveName = name;
+  return 0;
+}
+/*----------------------------------------------------------------------------*/
+
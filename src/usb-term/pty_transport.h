@@ -0,0 +1,38 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg pty_transport
+*/
+/**
+* Pseudo terminal transport: other programs connect to the slave side.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 14:48:21<br>
+* @pkgdoc pty_transport
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef PTY_TRANSPORT_H_1792248501
+#define PTY_TRANSPORT_H_1792248501
+/*----------------------------------------------------------------------------*/
+#include "poll_transport.h"
+/*----------------------------------------------------------------------------*/
+/**
+ * Pty master in raw mode. Slave device name is shown by name(), printer
+ * emulator or socat may be attached to it.
+ * Slave is kept opened by transport, so master does not hang up between peers.
+ */
+class PtyTransport : public PollTransport {
+protected:
+  std::string m_slaveName;
+  int m_slave = -1;
+  int openDevice(int *fd) override;
+public:
+  bool open();
+  void close() override;
+  ~PtyTransport() {close();}
+  std::string name() const override {return "pty " + m_slaveName;}
+  const std::string& slaveName() const {return m_slaveName;}
+};
+/*----------------------------------------------------------------------------*/
+#endif /*PTY_TRANSPORT_H_1792248501*/
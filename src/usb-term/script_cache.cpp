@@ -0,0 +1,257 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg script_cache
+*/
+/**
+* On-disk cache of compiled script files.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 18:05:12<br>
+* @pkgdoc script_cache
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "script_cache.h"
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QStandardPaths>
+#include <QDebug>
+#include <string.h>
+#include <type_traits>
+/*----------------------------------------------------------------------------*/
+static_assert(std::is_trivially_copyable<ScriptNode>::value, "ScriptNode is stored in cache as is");
+static const char MAGIC[4] = {'U', 'T', 'S', 'C'};
+/**
+ * Cache file header. Literals follow the header, nodes follow literals aligned to 8.
+ */
+struct ScriptCacheHeader {
+  char magic[4];
+  quint32 version;
+  quint32 nodeSize;     //sizeof(ScriptNode) of the writer
+  quint32 reserved;
+  quint64 hash;
+  qint64 sourceSize;
+  qint64 literalsSize;
+  qint64 nodeCount;
+};
+/*----------------------------------------------------------------------------*/
+static inline qint64 align8(qint64 size) {
+  return (size + 7) & ~7LL;
+}
+/*----------------------------------------------------------------------------*/
+static inline quint64 rotl(quint64 x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+/*----------------------------------------------------------------------------*/
+static inline quint64 fmix(quint64 k) {
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+/*----------------------------------------------------------------------------*/
+quint64 ScriptCache::hash(const char *data, qint64 size, quint64 seed)
+{
+  //MurmurHash3 x64 mixing: two lanes of 64 bit words, several GB/s
+  const quint64 c1 = 0x87c37b91114253d5ULL;
+  const quint64 c2 = 0x4cf5ad432745937fULL;
+  quint64 h1 = VERSION ^ fmix(seed);
+  quint64 h2 = VERSION;
+  qint64 i = 0;
+  for(; i + 16 <= size; i += 16) {
+    quint64 k1, k2;
+    memcpy(&k1, data + i, 8);
+    memcpy(&k2, data + i + 8, 8);
+    k1 *= c1; k1 = rotl(k1, 31); k1 *= c2; h1 ^= k1;
+    h1 = rotl(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+    k2 *= c2; k2 = rotl(k2, 33); k2 *= c1; h2 ^= k2;
+    h2 = rotl(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+  }
+  unsigned char tail[16] = {};
+  memcpy(tail, data + i, static_cast<size_t>(size - i));
+  quint64 k1, k2;
+  memcpy(&k1, tail, 8);
+  memcpy(&k2, tail + 8, 8);
+  k1 *= c1; k1 = rotl(k1, 31); k1 *= c2; h1 ^= k1;
+  k2 *= c2; k2 = rotl(k2, 33); k2 *= c1; h2 ^= k2;
+
+  h1 ^= static_cast<quint64>(size);
+  h2 ^= static_cast<quint64>(size);
+  h1 += h2;
+  h2 += h1;
+  h1 = fmix(h1);
+  h2 = fmix(h2);
+  return h1 + h2;
+}
+/*----------------------------------------------------------------------------*/
+QString ScriptCache::directory()
+{
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/scripts";
+}
+/*----------------------------------------------------------------------------*/
+QString ScriptCache::fileName(quint64 hash)
+{
+  return QString("%1/%2.bin").arg(directory()).arg(hash, 16, 16, QChar('0'));
+}
+/*----------------------------------------------------------------------------*/
+static bool validNode(const ScriptNode& node, qint64 literalsSize)
+{
+  switch(static_cast<int>(node.type)) {
+    case ScriptNode::Bytes:
+    case ScriptNode::WaitFor:
+      //Empty node is never compiled, zero size would divide expand()
+      return node.offset >= 0 && node.size > 0 && node.offset + static_cast<qint64>(node.size) <= literalsSize;
+    case ScriptNode::Counter:
+      return (node.size == 1 || node.size == 2 || node.size == 4) && node.step != 0
+          && (node.step > 0) == (node.first <= node.last);
+    case ScriptNode::Delay:
+    case ScriptNode::Flush:
+      return node.time >= 0;
+    default:
+      return false;
+  }
+}
+/*----------------------------------------------------------------------------*/
+bool ScriptCache::load(quint64 hash, qint64 sourceSize, CompiledScript *script)
+{
+  auto file = std::make_shared<QFile>(fileName(hash));
+  if(!file->open(QIODevice::ReadOnly)) {
+    return false;
+  }
+  qint64 size = file->size();
+  if(size < static_cast<qint64>(sizeof(ScriptCacheHeader))) {
+    return false;
+  }
+  const uchar *data = file->map(0, size);
+  if(!data) {
+    return false;
+  }
+  ScriptCacheHeader header;
+  memcpy(&header, data, sizeof(header));
+  qint64 nodesOffset = sizeof(header) + align8(header.literalsSize);
+  if(memcmp(header.magic, MAGIC, sizeof(MAGIC)) || header.version != VERSION || header.nodeSize != sizeof(ScriptNode)
+     || header.hash != hash || header.sourceSize != sourceSize
+     || header.literalsSize < 0 || header.literalsSize > INT_MAX
+     || header.nodeCount < 0 || header.nodeCount > size / static_cast<qint64>(sizeof(ScriptNode))
+     || nodesOffset + header.nodeCount * static_cast<qint64>(sizeof(ScriptNode)) != size) {
+    qWarning() << "Bad script cache file" << file->fileName();
+    return false;
+  }
+
+  CompiledScript result;
+  result.nodes.resize(static_cast<int>(header.nodeCount));
+  memcpy(result.nodes.data(), data + nodesOffset, header.nodeCount * sizeof(ScriptNode));
+  for(const auto& node : result.nodes) {
+    if(!validNode(node, header.literalsSize)) {
+      qWarning() << "Bad script cache file" << file->fileName();
+      return false;
+    }
+  }
+  result.literals = QByteArray::fromRawData(reinterpret_cast<const char *>(data + sizeof(header)),
+                                            static_cast<int>(header.literalsSize));
+  result.storage = file;
+  *script = result;
+  //Modification time is used as last access time by prune()
+  file->setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+  return true;
+}
+/*----------------------------------------------------------------------------*/
+void ScriptCache::prune()
+{
+  QDir dir(directory());
+  //Newest first
+  auto files = dir.entryInfoList(QStringList() << "*.bin", QDir::Files, QDir::Time);
+  qint64 total = 0;
+  for(const auto& info : files) {
+    total += info.size();
+    if(total > static_cast<qint64>(MAX_SIZE_MB) * 1024 * 1024) {
+      QFile::remove(info.filePath());
+    }
+  }
+}
+/*----------------------------------------------------------------------------*/
+bool ScriptCacheWriter::open(quint64 hash, qint64 sourceSize)
+{
+  discard();
+  QDir().mkpath(ScriptCache::directory());
+  m_file.setFileName(ScriptCache::fileName(hash));
+  m_hash = hash;
+  m_sourceSize = sourceSize;
+  m_literalsSize = 0;
+  m_nodes.clear();
+  m_ok = m_file.open(QIODevice::WriteOnly);
+  if(m_ok) {
+    //Header is written by commit()
+    ScriptCacheHeader header = {};
+    m_ok = m_file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header);
+  }
+  return m_ok;
+}
+/*----------------------------------------------------------------------------*/
+void ScriptCacheWriter::append(const CompiledScript& part)
+{
+  if(!m_ok) {
+    return;
+  }
+  if(m_literalsSize + part.literals.size() > INT_MAX) {
+    m_ok = false;
+    return;
+  }
+  for(ScriptNode node : part.nodes) {
+    node.offset += static_cast<int>(m_literalsSize);
+    m_nodes.append(node);
+  }
+  m_ok = m_file.write(part.literals) == part.literals.size();
+  m_literalsSize += part.literals.size();
+}
+/*----------------------------------------------------------------------------*/
+bool ScriptCacheWriter::commit()
+{
+  if(!m_ok) {
+    discard();
+    return false;
+  }
+  static const char zero[8] = {};
+  qint64 pad = align8(m_literalsSize) - m_literalsSize;
+  qint64 nodesSize = m_nodes.size() * static_cast<qint64>(sizeof(ScriptNode));
+
+  ScriptCacheHeader header = {};
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = ScriptCache::VERSION;
+  header.nodeSize = sizeof(ScriptNode);
+  header.hash = m_hash;
+  header.sourceSize = m_sourceSize;
+  header.literalsSize = m_literalsSize;
+  header.nodeCount = m_nodes.size();
+
+  m_ok = m_file.write(zero, pad) == pad
+      && m_file.write(reinterpret_cast<const char *>(m_nodes.constData()), nodesSize) == nodesSize
+      && m_file.seek(0)
+      && m_file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header)
+      && m_file.commit();
+  if(!m_ok) {
+    discard();
+    return false;
+  }
+  m_nodes.clear();
+  ScriptCache::prune();
+  return true;
+}
+/*----------------------------------------------------------------------------*/
+void ScriptCacheWriter::discard()
+{
+  if(m_file.isOpen()) {
+    //Temporary file is removed, cached file is not changed
+    m_file.cancelWriting();
+    m_file.commit();
+  }
+  m_nodes.clear();
+  m_ok = false;
+}
+/*----------------------------------------------------------------------------*/
+
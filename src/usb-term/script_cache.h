@@ -0,0 +1,62 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg script_cache
+*/
+/**
+* On-disk cache of compiled script files.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 18:05:12<br>
+* @pkgdoc script_cache
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef SCRIPT_CACHE_H_1792260312
+#define SCRIPT_CACHE_H_1792260312
+/*----------------------------------------------------------------------------*/
+#include <QString>
+#include <QSaveFile>
+#include "text_parser.h"
+/*----------------------------------------------------------------------------*/
+/**
+ * Compiled scripts are stored in files named by hash of the source text.
+ * File: header, literals, nodes. Literals are mapped on load, not read.
+ */
+class ScriptCache {
+public:
+  enum {
+    VERSION = 3,                           //Change with script grammar or ScriptNode layout
+    MAX_SIZE_MB = 1024                     //Oldest files are removed above this size
+  };
+  /**Fast 64 bit hash of source text. Seed is for compile options: initial codepage*/
+  static quint64 hash(const char *data, qint64 size, quint64 seed = 0);
+  static QString directory();
+  static QString fileName(quint64 hash);
+  /**Load compiled script of source with hash. Returns false if it is not cached*/
+  static bool load(quint64 hash, qint64 sourceSize, CompiledScript *script);
+  /**Remove oldest files while cache is bigger than MAX_SIZE_MB*/
+  static void prune();
+};
+
+/**
+ * Cache file written while script is compiled by parts.
+ * File appears in cache only after commit().
+ */
+class ScriptCacheWriter {
+  QSaveFile m_file;
+  quint64 m_hash = 0;
+  qint64 m_sourceSize = 0;
+  qint64 m_literalsSize = 0;
+  QVector<ScriptNode> m_nodes;
+  bool m_ok = false;
+public:
+  bool open(quint64 hash, qint64 sourceSize);
+  /**Append next compiled part of script*/
+  void append(const CompiledScript& part);
+  bool commit();
+  void discard();
+  ~ScriptCacheWriter() {discard();}
+};
+/*----------------------------------------------------------------------------*/
+#endif /*SCRIPT_CACHE_H_1792260312*/
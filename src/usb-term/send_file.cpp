@@ -0,0 +1,505 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg send_file
+*/
+/**
+* Streaming send of script or binary file without loading it into editor.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 16:20:33<br>
+* @pkgdoc send_file
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "send_file.h"
+#include "transport.h"
+#include "text_parser.h"
+#include "script_cache.h"
+#include <QFile>
+#include <QStringList>
+#include <string.h>
+#include <chrono>
+#include <algorithm>
+/*----------------------------------------------------------------------------*/
+typedef std::chrono::steady_clock Clock;
+/*----------------------------------------------------------------------------*/
+/**
+ * Mapped file shared by sender and transport buffers.
+ */
+struct MappedFile {
+  QFile file;
+  const uchar *data = nullptr;
+  qint64 size = 0;
+};
+/*----------------------------------------------------------------------------*/
+FileSender :: FileSender(Transport *transport)
+  : m_transport(transport)
+{
+}
+/*----------------------------------------------------------------------------*/
+FileSender :: ~FileSender()
+{
+  cancel();
+}
+/*----------------------------------------------------------------------------*/
+bool FileSender :: start(const QString& fileName)
+{
+  auto file = std::make_shared<MappedFile>();
+  file->file.setFileName(fileName);
+  if(!file->file.open(QIODevice::ReadOnly)) {
+    m_message = file->file.errorString();
+    m_error = true;
+    return false;
+  }
+  file->size = file->file.size();
+  if(file->size > 0) {
+    file->data = file->file.map(0, file->size);
+    if(!file->data) {
+      m_message = file->file.errorString();
+      m_error = true;
+      return false;
+    }
+  }
+  m_file = file;
+  m_data = reinterpret_cast<const char *>(file->data);
+  m_size = file->size;
+  startThread();
+  return true;
+}
+/*----------------------------------------------------------------------------*/
+void FileSender :: startThread()
+{
+  m_transport->setReceiveMonitor([this](const std::vector<uint8_t>& data) {
+    received(data);
+  });
+  m_thread = std::thread(&FileSender::run, this);
+}
+/*----------------------------------------------------------------------------*/
+void FileSender :: cancel()
+{
+  m_cancel = true;
+  if(m_thread.joinable()) {
+    m_thread.join();
+  }
+  m_transport->setReceiveMonitor(nullptr);
+}
+/*----------------------------------------------------------------------------*/
+bool FileSender :: waitQueue()
+{
+  //Back pressure: do not run ahead of device more than MAX_PENDING
+  while(m_transport->pendingBytes() > MAX_PENDING) {
+    if(m_cancel) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  return !m_cancel;
+}
+/*----------------------------------------------------------------------------*/
+bool FileSender :: send(const TransportBuffer& buffer)
+{
+  if(buffer.size == 0) {
+    return true;
+  }
+  if(!waitQueue()) {
+    return false;
+  }
+  if(m_transport->writeBuffer(buffer) < 0) {
+    m_message = QString::fromStdString(m_transport->message());
+    m_error = true;
+    return false;
+  }
+  m_sent += buffer.size;
+  return true;
+}
+/*----------------------------------------------------------------------------*/
+bool FileSender :: send(const QByteArray& data)
+{
+  //Transport keeps reference to data instead of copy
+  auto owner = std::make_shared<QByteArray>(data);
+  TransportBuffer buffer;
+  buffer.data = reinterpret_cast<const uint8_t *>(owner->constData());
+  buffer.size = owner->size();
+  buffer.owner = owner;
+  return send(buffer);
+}
+/*----------------------------------------------------------------------------*/
+bool FileSender :: send(const CompiledScript& script)
+{
+  auto writer = [this](const QByteArray& chunk) {
+    return send(chunk);
+  };
+  int from = 0;
+  for(int i = 0; i < script.nodes.size(); i++) {
+    if(!script.nodes[i].isCommand()) {
+      continue;
+    }
+    if(!script.expand(writer, CHUNK_SIZE, from, i) || !execute(script, script.nodes[i])) {
+      return false;
+    }
+    from = i + 1;
+  }
+  return script.expand(writer, CHUNK_SIZE, from);
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Sleep until deadline by monotonic clock. Scheduler wakes thread up late,
+ * so the last SPIN_US are spent in busy wait.
+ */
+static void sleepUntil(Clock::time_point deadline, const std::atomic<bool>& cancel)
+{
+  const Clock::duration spin = std::chrono::microseconds(FileSender::SPIN_US);
+  for(;;) {
+    auto now = Clock::now();
+    if(now >= deadline || cancel) {
+      return;
+    }
+    auto left = deadline - now;
+    if(left > spin) {
+      std::this_thread::sleep_for(std::min<Clock::duration>(left - spin, std::chrono::milliseconds(20)));
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
+/*----------------------------------------------------------------------------*/
+bool FileSender :: waitFlush()
+{
+  while(m_transport->pendingBytes() > 0) {
+    if(m_cancel) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+  return !m_cancel;
+}
+/*----------------------------------------------------------------------------*/
+bool FileSender :: execute(const CompiledScript& script, const ScriptNode& node)
+{
+  ScriptTiming timing {node.type, node.time, 0, false};
+  Clock::time_point start = Clock::now();
+  switch(node.type) {
+    case ScriptNode::Flush:
+      if(!waitFlush()) {
+        return false;
+      }
+      break;
+    case ScriptNode::Delay:
+      //Pause is counted from the moment device has accepted previous data
+      if(!waitFlush()) {
+        return false;
+      }
+      start = Clock::now();
+      sleepUntil(start + std::chrono::nanoseconds(node.time), m_cancel);
+      break;
+    case ScriptNode::WaitFor: {
+      QByteArray pattern = script.literals.mid(node.offset, node.size);
+      Clock::time_point deadline = start + std::chrono::nanoseconds(node.time);
+      std::unique_lock<std::mutex> lock(m_receiveMutex);
+      int found;
+      while((found = m_received.indexOf(pattern)) < 0 && !m_cancel) {
+        auto now = Clock::now();
+        if(now >= deadline) {
+          timing.timeout = true;
+          break;
+        }
+        m_receiveCondition.wait_until(lock, std::min(deadline, now + std::chrono::milliseconds(20)));
+      }
+      if(found >= 0) {
+        m_received.remove(0, found + pattern.size());
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  if(m_cancel) {
+    return false;
+  }
+  timing.achieved = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+  if(timing.type == ScriptNode::Delay) {
+    qint64 jitter = timing.achieved - timing.requested;
+    m_jitterMin = m_delays ? std::min(m_jitterMin, jitter) : jitter;
+    m_jitterMax = m_delays ? std::max(m_jitterMax, jitter) : jitter;
+    m_jitterSum += jitter;
+    m_delays++;
+  }
+  m_commands++;
+  if(m_timings.size() < static_cast<size_t>(MAX_TIMINGS)) {
+    m_timings.push_back(timing);
+  }
+  if(timing.timeout) {
+    m_message = QString("Timeout waiting for %1").arg(QString::fromLatin1(script.literals.mid(node.offset, node.size).toHex(' ')));
+    m_error = true;
+    return false;
+  }
+  return true;
+}
+/*----------------------------------------------------------------------------*/
+void FileSender :: received(const std::vector<uint8_t>& data)
+{
+  std::lock_guard<std::mutex> lock(m_receiveMutex);
+  m_received.append(reinterpret_cast<const char *>(data.data()), static_cast<int>(data.size()));
+  if(m_received.size() > MAX_RECEIVED) {
+    m_received.remove(0, m_received.size() - MAX_RECEIVED);
+  }
+  m_receiveCondition.notify_all();
+}
+/*----------------------------------------------------------------------------*/
+QString FileSender :: timingReport(int maxLines) const
+{
+  auto ms = [](qint64 ns) {
+    return QString::number(ns / 1e6, 'f', 3);
+  };
+  QStringList lines;
+  for(const auto& timing : m_timings) {
+    qint64 jitter = timing.achieved - timing.requested;
+    if(lines.size() >= maxLines) {
+      break;
+    }
+    switch(timing.type) {
+      case ScriptNode::Delay:
+        lines << QString("@delay %1 ms: %2 ms (%3%4 us)").arg(ms(timing.requested), ms(timing.achieved),
+                                                            jitter >= 0 ? "+" : "", QString::number(jitter / 1e3, 'f', 1));
+        break;
+      case ScriptNode::Flush:
+        lines << QString("@flush: %1 ms").arg(ms(timing.achieved));
+        break;
+      case ScriptNode::WaitFor:
+        lines << (timing.timeout ? QString("@wait-for: timeout %1 ms").arg(ms(timing.requested))
+                                 : QString("@wait-for: %1 ms").arg(ms(timing.achieved)));
+        break;
+      default:
+        break;
+    }
+  }
+  if(m_commands > lines.size()) {
+    lines << QString("... %1 more").arg(m_commands - lines.size());
+  }
+  if(m_delays) {
+    lines << QString("Delay jitter over %1 delays: min %2 us, avg %3 us, max %4 us").arg(
+               QString::number(m_delays),
+               QString::number(m_jitterMin / 1e3, 'f', 1),
+               QString::number(m_jitterSum / 1e3 / m_delays, 'f', 1),
+               QString::number(m_jitterMax / 1e3, 'f', 1));
+  }
+  return lines.join('\n');
+}
+/*----------------------------------------------------------------------------*/
+void FileSender :: finish()
+{
+  if(!m_error && m_cancel) {
+    m_message = "Cancelled";
+    m_error = true;
+  }
+  m_finished = true;
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Places to split script line longer than chunk, where lexer continues as at line start:
+ * delimiter outside strings, comments and parentheses, not around repeat and not in
+ * arguments of directive. Line with checksum field is not split: its offsets count from
+ * line start. Rest of line is checked for checksum fields once.
+ */
+class LineSplitter {
+  qint64 m_lineEnd = -1;      //Line end checked for checksum fields
+  bool m_checksum = false;
+  /**Scan [pos, to) from state, returns last split place or -1, sets *checksum*/
+  static qint64 scan(const char *data, qint64 pos, qint64 to, qint64 size, ParserState state, bool *checksum);
+public:
+  /**Split place in (pos, limit], or -1 if there is none*/
+  qint64 split(const char *data, qint64 pos, qint64 limit, qint64 size, ParserState state);
+};
+/*----------------------------------------------------------------------------*/
+static inline bool isScriptDelimiter(char c) {
+  return c == ' ' || c == ',' || (c >= '\t' && c <= '\r');
+}
+/*----------------------------------------------------------------------------*/
+qint64 LineSplitter :: scan(const char *data, qint64 pos, qint64 to, qint64 size, ParserState state, bool *checksum)
+{
+  qint64 best = -1;
+  int depth = 0;          //Parentheses of typed numbers
+  int blocked = 0;        //Tokens that must stay with previous one
+  qint64 i = pos;
+  bool inString = state == ParserInString;
+  *checksum = false;
+  while(i < to) {
+    char c = data[i];
+    if(inString || c == '"') {
+      for(i += inString ? 0 : 1; i < to && data[i] != '"'; i++) {
+        if(data[i] == '\\') {
+          i++;
+        }
+      }
+      if(i >= to) {
+        break;
+      }
+      i++;
+      inString = false;
+      blocked = blocked > 0 ? blocked - 1 : 0;
+      continue;
+    }
+    if(c == '#' || c == '\n') {
+      break;
+    }
+    if(isScriptDelimiter(c)) {
+      qint64 next = i;
+      while(next < size && isScriptDelimiter(data[next]) && data[next] != '\n') {
+        next++;
+      }
+      if(!depth && !blocked && (next >= size || data[next] != '*')) {
+        best = std::min(next, to);
+      }
+      i = next;
+      continue;
+    }
+    qint64 start = i;
+    while(i < to && !isScriptDelimiter(data[i]) && data[i] != '"' && data[i] != '#') {
+      if(data[i] == '(') {
+        depth++;
+      } else if(data[i] == ')' && depth) {
+        depth--;
+      } else if(data[i] == '{') {
+        *checksum = true;
+      }
+      i++;
+    }
+    blocked = blocked > 0 ? blocked - 1 : 0;
+    if(data[start] == '@') {
+      blocked = 2; //@delay TIME, @wait-for "BYTES" TIMEOUT, @codepage NAME
+    } else if(data[i - 1] == '*') {
+      blocked = 1; //Repeat count follows
+    }
+  }
+  return best;
+}
+/*----------------------------------------------------------------------------*/
+qint64 LineSplitter :: split(const char *data, qint64 pos, qint64 limit, qint64 size, ParserState state)
+{
+  if(pos >= m_lineEnd) {
+    const char *nl = static_cast<const char *>(memchr(data + pos, '\n', size - pos));
+    m_lineEnd = nl ? nl - data : size;
+    scan(data, pos, m_lineEnd, size, state, &m_checksum);
+  }
+  bool checksum;
+  qint64 best = scan(data, pos, limit, size, state, &checksum);
+  return m_checksum || best <= pos ? -1 : best;
+}
+/*----------------------------------------------------------------------------*/
+void ScriptFileSender :: run()
+{
+  const char *data = m_data;
+  qint64 pos = 0;
+  ParserState state = ParserNormal;
+  Codepage::Id codepage = m_codepage;
+  //Data of string literal not closed yet: sent when string is closed,
+  //dropped if file ends inside string, like parseText() does
+  CompiledScript pending;
+
+  //Same text was compiled before: send cached script without parsing
+  quint64 hash = ScriptCache::hash(data, m_size, m_codepage);
+  if(m_useCache && ScriptCache::load(hash, m_size, &pending)) {
+    m_cached = true;
+    m_processed = m_size;
+    send(pending);
+    finish();
+    return;
+  }
+  ScriptCacheWriter cache;
+  if(m_useCache) {
+    cache.open(hash, m_size);
+  }
+
+  //Chunk per core: parseParallel() splits it between threads
+  int threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  LineSplitter splitter;
+  while(pos < m_size && !m_cancel) {
+    //Chunks are split at line feed: fragments for parseFragment() and whole UTF-8 chars.
+    //Line longer than chunk is split at delimiter, memory does not depend on line length
+    qint64 end = pos + static_cast<qint64>(CHUNK_SIZE) * threads;
+    if(end >= m_size) {
+      end = m_size;
+    } else {
+      const char *nl = static_cast<const char *>(memrchr(data + pos, '\n', end - pos));
+      end = nl ? nl - data + 1 : splitter.split(data, pos, end, m_size, state);
+      if(end < 0) {
+        m_message = QString("Line at offset %1 is too long: no place to split it in %2 bytes").arg(pos).arg(CHUNK_SIZE * threads);
+        m_error = true;
+        break;
+      }
+    }
+
+    QString text = QString::fromUtf8(data + pos, static_cast<int>(end - pos));
+    int base = pending.literals.size();
+    int stringStart = -1;
+    int errorPosition = -1;
+    state = parseParallel(text, state, &pending, &stringStart, &codepage, threads, &errorPosition);
+    if(state == ParserError) {
+      qint64 offset = pos + text.left(errorPosition).toUtf8().size();
+      qint64 line = 1 + std::count(data, data + offset, '\n');
+      m_message = QString("Syntax error in line %1 at offset %2").arg(line).arg(offset);
+      m_error = true;
+      break;
+    }
+    pos = end;
+    m_processed = pos;
+
+    if(state == ParserInString) {
+      //String opened in previous chunk: all pending data is in the string
+      CompiledScript tail = pending.splitTail(stringStart >= 0 ? base + stringStart : 0);
+      cache.append(pending);
+      if(!send(pending)) {
+        break;
+      }
+      pending = tail;
+      continue;
+    }
+    cache.append(pending);
+    if(!send(pending)) {
+      break;
+    }
+    pending = CompiledScript();
+  }
+
+  if(!m_error && !m_cancel && state == ParserInString) {
+    m_message = "Syntax error: unterminated string";
+    m_error = true;
+  }
+  if(!m_error && !m_cancel) {
+    cache.commit();
+  }
+  finish();
+}
+/*----------------------------------------------------------------------------*/
+void BinaryFileSender :: run()
+{
+  qint64 pos = 0;
+  while(pos < m_size && !m_cancel) {
+    TransportBuffer buffer;
+    buffer.data = reinterpret_cast<const uint8_t *>(m_data + pos);
+    buffer.size = static_cast<size_t>(std::min<qint64>(CHUNK_SIZE, m_size - pos));
+    buffer.owner = m_file;
+    if(!send(buffer)) {
+      break;
+    }
+    pos += buffer.size;
+    m_processed = pos;
+  }
+  finish();
+}
+/*----------------------------------------------------------------------------*/
+void ScriptDataSender :: start(const CompiledScript& script)
+{
+  m_script = script;
+  m_size = static_cast<qint64>(script.size());
+  startThread();
+}
+/*----------------------------------------------------------------------------*/
+void ScriptDataSender :: run()
+{
+  send(m_script);
+  m_processed = m_sent.load();
+  finish();
+}
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,160 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg send_file
+*/
+/**
+* Streaming send of script or binary file without loading it into editor.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 16:20:33<br>
+* @pkgdoc send_file
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef SEND_FILE_H_1792254033
+#define SEND_FILE_H_1792254033
+/*----------------------------------------------------------------------------*/
+#include <QString>
+#include <QByteArray>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include "text_parser.h"
+/*----------------------------------------------------------------------------*/
+class Transport;
+struct TransportBuffer;
+struct MappedFile;
+/**
+ * Achieved timing of script command.
+ */
+struct ScriptTiming {
+  ScriptNode::Type type;
+  qint64 requested; //Delay or wait timeout, ns
+  qint64 achieved;  //Measured time, ns
+  bool timeout;
+};
+/**
+ * File is mapped to memory and sent by chunks from own thread.
+ * Thread waits while transport queue is full, so memory use does not depend on file size.
+ * Script commands are executed by the same thread: @delay and @flush wait until device
+ * accepts queued data, @wait-for looks for answer received after the previous match.
+ */
+class FileSender {
+public:
+  enum {
+    CHUNK_SIZE = 1024 * 1024,      //Bytes processed at once
+    MAX_PENDING = 4 * 1024 * 1024, //Transport queue limit
+    MAX_RECEIVED = 64 * 1024,      //Received data kept for @wait-for
+    MAX_TIMINGS = 1000,            //Timings kept for report, later commands are only counted
+    SPIN_US = 1000                 //Busy wait at the end of delay
+  };
+protected:
+  Transport *m_transport;
+  std::shared_ptr<MappedFile> m_file;
+  const char *m_data = nullptr;
+  qint64 m_size = 0;
+  std::thread m_thread;
+  std::atomic<bool> m_cancel {false};
+  std::atomic<bool> m_finished {false};
+  std::atomic<qint64> m_processed {0}; //File bytes processed
+  std::atomic<qint64> m_sent {0};      //Bytes queued to transport
+  std::atomic<bool> m_cached {false};  //Compiled script was loaded from cache
+  QString m_message;
+  bool m_error = false;
+  std::vector<ScriptTiming> m_timings;
+  qint64 m_commands = 0;
+  //Delay jitter of all delays, ns
+  qint64 m_delays = 0;
+  qint64 m_jitterSum = 0;
+  qint64 m_jitterMin = 0;
+  qint64 m_jitterMax = 0;
+  //Data received while running, for @wait-for
+  std::mutex m_receiveMutex;
+  std::condition_variable m_receiveCondition;
+  QByteArray m_received;
+
+  virtual void run() = 0;
+  void startThread();
+  bool waitQueue();
+  bool send(const QByteArray& data);
+  bool send(const TransportBuffer& buffer);
+  /**Expand generators by chunks while sending, execute commands*/
+  bool send(const CompiledScript& script);
+  bool execute(const CompiledScript& script, const ScriptNode& node);
+  bool waitFlush();
+  void received(const std::vector<uint8_t>& data);
+  void finish();
+public:
+  explicit FileSender(Transport *transport);
+  /**Derived class destructor must call cancel(): thread runs derived run()*/
+  virtual ~FileSender();
+
+  bool start(const QString& fileName);
+  void cancel();
+
+  /**Thread is done: all data is queued to transport, or error*/
+  bool isFinished() const {return m_finished;}
+  qint64 fileSize() const {return m_size;}
+  qint64 processed() const {return m_processed;}
+  qint64 sent() const {return m_sent;}
+  bool isCached() const {return m_cached;}
+  /**Valid after isFinished()*/
+  bool isError() const {return m_error;}
+  const QString& message() const {return m_message;}
+  /**Requested and achieved timing of first MAX_TIMINGS commands. Valid after isFinished()*/
+  const std::vector<ScriptTiming>& timings() const {return m_timings;}
+  /**Number of executed commands. Valid after isFinished()*/
+  qint64 commandCount() const {return m_commands;}
+  /**Timing lines for log, first maxLines commands and jitter summary*/
+  QString timingReport(int maxLines = 20) const;
+};
+
+/**
+ * Script file compiled by line aligned chunks, every compiled chunk
+ * is queued to transport at once and appended to cache file.
+ */
+class ScriptFileSender : public FileSender {
+  bool m_useCache = true;
+  Codepage::Id m_codepage = Codepage::Utf8;
+protected:
+  void run() override;
+public:
+  explicit ScriptFileSender(Transport *transport) : FileSender(transport) {}
+  ~ScriptFileSender() {cancel();}
+  /**Compiled script is kept in ScriptCache and reused while file is not changed*/
+  void setUseCache(bool use) {m_useCache = use;}
+  /**Codepage of strings until the first @codepage of file*/
+  void setCodepage(Codepage::Id codepage) {m_codepage = codepage;}
+};
+
+/**
+ * Binary file sent as is. Transport gets mapped pages without copy,
+ * mapping is kept while transport uses them.
+ */
+class BinaryFileSender : public FileSender {
+protected:
+  void run() override;
+public:
+  explicit BinaryFileSender(Transport *transport) : FileSender(transport) {}
+  ~BinaryFileSender() {cancel();}
+};
+
+/**
+ * Script compiled in editor. Generators are expanded by chunks
+ * while sending, so big repeats do not take memory.
+ */
+class ScriptDataSender : public FileSender {
+  CompiledScript m_script;
+protected:
+  void run() override;
+public:
+  explicit ScriptDataSender(Transport *transport) : FileSender(transport) {}
+  ~ScriptDataSender() {cancel();}
+  void start(const CompiledScript& script);
+};
+/*----------------------------------------------------------------------------*/
+#endif /*SEND_FILE_H_1792254033*/
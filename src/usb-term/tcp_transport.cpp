@@ -0,0 +1,137 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg tcp_transport
+*/
+/**
+* Raw TCP transport for network printers (port 9100, JetDirect).
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 14:31:09<br>
+* @pkgdoc tcp_transport
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "tcp_transport.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+/*----------------------------------------------------------------------------*/
+/**
+ * Non blocking connect: returns 0, EINPROGRESS or errno value,
+ * socket in *fd.
+ */
+static int tcp_connect(const TcpAddress& address, bool noDelay, int *fd)
+{
+  int s = socket(address.family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, address.protocol);
+  if(s < 0) {
+    return errno;
+  }
+  *fd = s;
+  int flag = noDelay ? 1 : 0;
+  setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+  flag = 1;
+  setsockopt(s, SOL_SOCKET, SO_KEEPALIVE, &flag, sizeof(flag));
+  if(connect(s, reinterpret_cast<const struct sockaddr *>(&address.address), address.length) == 0) {
+    return 0;
+  }
+  return errno;
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Host is resolved here, so reconnect in I/O thread does not wait for DNS.
+ */
+bool TcpTransport :: open(const TcpSettings& settings)
+{
+  close();
+  m_settings = settings;
+  m_addresses.clear();
+  m_next = 0;
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo *list = nullptr;
+  char port[16];
+  snprintf(port, sizeof(port), "%u", m_settings.port);
+  int r = getaddrinfo(m_settings.host.c_str(), port, &hints, &list);
+  if(r != 0 || !list) {
+    m_error = -EHOSTUNREACH;
+    m_message = name() + ": " + (r ? gai_strerror(r) : strerror(EHOSTUNREACH));
+    return false;
+  }
+  for(auto ai = list; ai; ai = ai->ai_next) {
+    TcpAddress address;
+    memset(&address, 0, sizeof(address));
+    memcpy(&address.address, ai->ai_addr, ai->ai_addrlen);
+    address.length = ai->ai_addrlen;
+    address.family = ai->ai_family;
+    address.protocol = ai->ai_protocol;
+    m_addresses.push_back(address);
+  }
+  freeaddrinfo(list);
+  return start();
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Connection to next address is started, addresses refusing at once are skipped.
+ */
+int TcpTransport :: openDevice(int *fd)
+{
+  int err = EHOSTUNREACH;
+  for(size_t i = 0; i < m_addresses.size(); i++) {
+    const TcpAddress& address = m_addresses[m_next];
+    m_next = (m_next + 1) % m_addresses.size();
+    *fd = -1;
+    err = tcp_connect(address, m_settings.noDelay, fd);
+    if(!err || err == EINPROGRESS) {
+      break;
+    }
+    if(*fd >= 0) {
+      ::close(*fd);
+      *fd = -1;
+    }
+  }
+  return err;
+}
+/*----------------------------------------------------------------------------*/
+int TcpTransport :: openResult(int fd)
+{
+  int err = 0;
+  socklen_t len = sizeof(err);
+  if(getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0) {
+    return errno;
+  }
+  return err;
+}
+/*----------------------------------------------------------------------------*/
+std::string TcpTransport :: statistics(int fd) const
+{
+#ifdef TCP_INFO
+  struct tcp_info info;
+  socklen_t len = sizeof(info);
+  if(fd >= 0 && getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &len) == 0) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "RTT %.3f ms (+/-%.3f)", info.tcpi_rtt / 1e3, info.tcpi_rttvar / 1e3);
+    return buffer;
+  }
+#else
+  (void) fd;
+#endif
+  return std::string();
+}
+/*----------------------------------------------------------------------------*/
+std::string TcpTransport :: name() const
+{
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), ":%u%s", m_settings.port, m_settings.noDelay ? "" : " (Nagle)");
+  return m_settings.host + buffer;
+}
+/*----------------------------------------------------------------------------*/
+
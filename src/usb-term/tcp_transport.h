@@ -0,0 +1,57 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg tcp_transport
+*/
+/**
+* Raw TCP transport for network printers (port 9100, JetDirect).
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 14:31:09<br>
+* @pkgdoc tcp_transport
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef TCP_TRANSPORT_H_1792247469
+#define TCP_TRANSPORT_H_1792247469
+/*----------------------------------------------------------------------------*/
+#include "poll_transport.h"
+#include <sys/socket.h>
+/*----------------------------------------------------------------------------*/
+struct TcpSettings {
+  std::string host;
+  uint16_t port = 9100;
+  bool noDelay = true; //TCP_NODELAY: send small writes without Nagle delay
+};
+
+struct TcpAddress {
+  struct sockaddr_storage address;
+  socklen_t length;
+  int family;
+  int protocol;
+};
+
+/**
+ * Non blocking TCP client. Connection is reestablished if peer closes it.
+ * Host is resolved by open(), its addresses are tried in turn.
+ * Write completion message contains kernel RTT estimation.
+ */
+class TcpTransport : public PollTransport {
+protected:
+  TcpSettings m_settings;
+  std::vector<TcpAddress> m_addresses;
+  size_t m_next = 0;      //Address of next connection
+  int openDevice(int *fd) override;
+  int openResult(int fd) override;
+  int openAttempts() const override {return static_cast<int>(m_addresses.size());}
+  std::string statistics(int fd) const override;
+public:
+  enum {
+    DEFAULT_PORT = 9100
+  };
+  bool open(const TcpSettings& settings);
+  ~TcpTransport() {close();}
+  std::string name() const override;
+};
+/*----------------------------------------------------------------------------*/
+#endif /*TCP_TRANSPORT_H_1792247469*/
@@ -0,0 +1,100 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg capture_store_test
+*/
+/**
+* Checks of capture store fields and payloads.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 18.10.2026 10:00:00<br>
+* @pkgdoc capture_store_test
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "tests.h"
+#include "capture_store.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <string.h>
+/*----------------------------------------------------------------------------*/
+/**
+ * Many small transfers and a large one, check of stored fields, payloads
+ * and release of oldest records. Benchmark reports speed and memory per record.
+ */
+bool captureTest(bool benchmark) {
+  CaptureStore store;
+  const qint64 records = benchmark ? 2000000 : 200000;
+  uchar chunk[64];
+  QElapsedTimer timer;
+  timer.start();
+  for(qint64 i = 0; i < records; i++) {
+    size_t size = static_cast<size_t>(i % 64);
+    memset(chunk, static_cast<int>(i & 0xff), size);
+    store.append(i & 1 ? CaptureStore::Sent : CaptureStore::Received, chunk, size, i % 7 ? 0 : -7, 0x81, i + 1);
+  }
+  double seconds = timer.nsecsElapsed() / 1e9;
+  QByteArray large(CaptureStore::PAGE_BYTES + 5, 'L');
+  qint64 largeIndex = store.append(CaptureStore::Received, large.constData(), large.size());
+
+  bool ok = store.count() == records + 1 && store.first() == 0 && store.payload(largeIndex) == large;
+  for(qint64 i = 0; ok && i < records; i += 9973) {
+    size_t size = static_cast<size_t>(i % 64);
+    ok = store.time(i) == i + 1 && store.length(i) == size && store.direction(i) == (i & 1 ? CaptureStore::Sent : CaptureStore::Received)
+        && store.status(i) == (i % 7 ? 0 : -7) && store.endpoint(i) == 0x81
+        && store.payload(i) == QByteArray(static_cast<int>(size), static_cast<char>(i & 0xff));
+  }
+  ok = check("Capture store:", ok && store.copy(62, 3, 70) == QByteArray(62, 62).append(QByteArray(8, 63)));
+  if(benchmark) {
+    qDebug() << "Capture append:" << records / seconds / 1e6 << "M records/s,"
+             << static_cast<double>(store.memory() - store.bytes()) / store.count() << "bytes per record overhead";
+  }
+
+  qint64 memory = store.memory();
+  qint64 kept = records - 100;
+  store.release(kept);
+  bool released = store.first() == kept && store.memory() < memory - CaptureStore::PAGE_BYTES && store.payload(largeIndex) == large
+      && store.payload(kept + 1) == QByteArray(static_cast<int>((kept + 1) % 64), static_cast<char>((kept + 1) & 0xff));
+  store.setLimit(2 * CaptureStore::PAGE_BYTES);
+  released = released && store.first() == largeIndex && store.payload(largeIndex) == large;
+  store.append(CaptureStore::Sent, "end", 3);
+  released = released && store.first() == largeIndex + 1 && store.payload(largeIndex + 1) == "end"
+      && store.memory() < 2 * CaptureStore::PAGE_BYTES;
+  store.clear();
+  released = released && store.first() == 0 && store.count() == 0 && store.memory() == 0;
+  return check("Capture release:", released) && ok;
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Flood of records of random size under limit: memory stays bounded,
+ * newest records are kept whole.
+ */
+bool captureSoakTest(qint64 records) {
+  const qint64 limit = 16 * CaptureStore::PAGE_BYTES;
+  CaptureStore store;
+  store.setLimit(limit);
+  QByteArray chunk(1024, Qt::Uninitialized);
+  quint32 seed = 1;
+  qint64 peak = 0;
+  bool ok = true;
+  QElapsedTimer timer;
+  timer.start();
+  for(qint64 i = 0; i < records; i++) {
+    seed = seed * 1103515245 + 12345;
+    size_t size = seed >> 22;
+    chunk[0] = static_cast<char>(i);
+    store.append(CaptureStore::Received, chunk.constData(), size);
+    if(!(i & 0xfff)) {
+      peak = std::max(peak, store.memory());
+      ok = ok && store.length(i) == size && (!size || store.data(i)[0] == static_cast<uchar>(i));
+    }
+  }
+  double seconds = timer.nsecsElapsed() / 1e9;
+  peak = std::max(peak, store.memory());
+  qDebug() << "Capture soak:" << records << "records," << store.bytes() / 1e6 << "MB in" << seconds << "s, peak memory"
+           << peak / 1e6 << "MB, kept" << store.count() - store.first() << "records";
+  //Limit may be exceeded by current page and blocks of columns being started
+  return check("Capture soak:", ok && peak <= limit + CaptureStore::PAGE_BYTES + 64 * CaptureColumn<qint64>::BLOCK
+               && store.count() == records && (store.bytes() < limit || store.first() > 0));
+}
+/*----------------------------------------------------------------------------*/
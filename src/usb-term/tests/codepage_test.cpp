@@ -0,0 +1,59 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg codepage_test
+*/
+/**
+* Checks of single byte codepage tables.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 18.10.2026 10:00:00<br>
+* @pkgdoc codepage_test
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "tests.h"
+#include "codepage.h"
+#include <QElapsedTimer>
+/*----------------------------------------------------------------------------*/
+/**
+ * Round trip of all mapped chars and of receipt text.
+ * Benchmark measures transcoding of multi megabyte text.
+ */
+bool codepageTest(bool benchmark) {
+  bool tables = true;
+  for(int id = Codepage::Cp437; id < Codepage::COUNT; id++) {
+    for(int b = 0; b < 256; b++) {
+      ushort u = Codepage::decode(static_cast<Codepage::Id>(id), static_cast<uchar>(b));
+      if(u != QChar::ReplacementCharacter && static_cast<uchar>(Codepage::encode(static_cast<Codepage::Id>(id), u)) != b) {
+        tables = false;
+        qDebug() << "FAIL" << Codepage::name(static_cast<Codepage::Id>(id)) << b;
+      }
+    }
+  }
+  tables = tables && Codepage::encode(Codepage::Cp866, QString::fromUtf8("\u0422\u0435\u0441\u0442 \u2116")) == QByteArray("\x92\xa5\xe1\xe2 \xfc")
+      && Codepage::encode(Codepage::Cp1251, QString::fromUtf8("\u0490\u0457 \u20ac")) == QByteArray("\xa5\xbf \x88")
+      && Codepage::encode(Codepage::Cp437, QString::fromUtf8("\u00e9\u4e2d")) == QByteArray("\x82?");
+  bool ok = check("Codepage tables:", tables);
+
+  QString line = QString::fromUtf8("\u0427\u0435\u043a \u2116 00123 \u0421\u0443\u043c\u0430: 150.00 \u0433\u0440\u043d\n");
+  QString receipt;
+  while(receipt.size() < (benchmark ? 4 * 1024 * 1024 : 64 * 1024)) {
+    receipt += line;
+  }
+  QElapsedTimer timer;
+  timer.start();
+  QByteArray encoded = Codepage::encode(Codepage::Cp866, receipt);
+  qint64 encodeNs = timer.nsecsElapsed();
+  timer.restart();
+  QString decoded = Codepage::decode(Codepage::Cp866, encoded);
+  qint64 decodeNs = timer.nsecsElapsed();
+  ok = check("Receipt round trip:", decoded == receipt) && ok;
+  if(benchmark) {
+    double megachars = receipt.size() / 1e6;
+    qDebug() << "Receipt" << megachars << "M chars, encode:" << megachars / (encodeNs / 1e9) << "M chars/s, decode:"
+             << megachars / (decodeNs / 1e9) << "M chars/s";
+  }
+  return ok;
+}
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,69 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg crc_test
+*/
+/**
+* Checks of CRC-16/CCITT-FALSE, CRC-32 and XOR against reference values.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 18.10.2026 10:00:00<br>
+* @pkgdoc crc_test
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "tests.h"
+#include "crc.h"
+#include <QByteArray>
+#include <QElapsedTimer>
+/*----------------------------------------------------------------------------*/
+/**
+ * Check values of standard test string, split processing and bit by bit implementation.
+ * Benchmark compares speed with bit by bit implementation on 64 MB.
+ */
+bool crcTest(bool benchmark) {
+  const char checkString[] = "123456789";
+  bool ok = check("CRC check values:", Crc::crc16(checkString, 9) == 0x29B1 && Crc::crc32(checkString, 9) == 0xCBF43926
+                  && Crc::xor8(checkString, 9) == 0x31);
+
+  const int small = 1000003;
+  QByteArray data(benchmark ? 64 * 1024 * 1024 + 5 : small, Qt::Uninitialized);
+  quint32 seed = 1;
+  for(int i = 0; i < data.size(); i++) {
+    seed = seed * 1103515245 + 12345;
+    data[i] = static_cast<char>(seed >> 24);
+  }
+  QElapsedTimer timer;
+  timer.start();
+  quint16 bitCrc = 0xFFFF;
+  for(int i = 0; i < small; i++) {
+    bitCrc ^= static_cast<quint16>(static_cast<uchar>(data[i]) << 8);
+    for(int bit = 0; bit < 8; bit++) {
+      bitCrc = static_cast<quint16>(bitCrc & 0x8000 ? (bitCrc << 1) ^ 0x1021 : bitCrc << 1);
+    }
+  }
+  double bitMegabytes = small / 1e6 / (timer.nsecsElapsed() / 1e9);
+  bool split = Crc::crc32(data.constData() + 13, small - 13, Crc::crc32(data.constData(), 13))
+      == Crc::crc32(data.constData(), small)
+      && Crc::xor8(data.constData() + 5, small - 5, Crc::xor8(data.constData(), 5)) == Crc::xor8(data.constData(), small);
+  ok = check("CRC parts:", split && Crc::crc16(data.constData(), small) == bitCrc) && ok;
+  const char frame[] = "123456789\x29\xb1";
+  ok = check("CRC frame:", Crc::checkFrame(Crc::Crc16, frame, 11, true) && !Crc::checkFrame(Crc::Crc16, frame, 11, false)) && ok;
+  if(!benchmark) {
+    return ok;
+  }
+
+  double megabytes = data.size() / 1e6;
+  auto measure = [&](const char *name, Crc::Kind kind) {
+    timer.restart();
+    volatile quint32 result = Crc::update(kind, data.constData(), data.size(), Crc::init(kind));
+    (void)result;
+    qDebug() << name << megabytes / (timer.nsecsElapsed() / 1e9) << "MB/s";
+  };
+  qDebug() << "CRC-16 bit by bit:" << bitMegabytes << "MB/s";
+  measure("CRC-16:", Crc::Crc16);
+  measure("CRC-32:", Crc::Crc32);
+  measure("XOR:", Crc::Xor8);
+  return ok;
+}
+/*----------------------------------------------------------------------------*/
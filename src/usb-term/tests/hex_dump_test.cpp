@@ -0,0 +1,138 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg hex_dump_test
+*/
+/**
+* Checks of table based hex dump against previous QTextStream implementation.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 18.10.2026 10:00:00<br>
+* @pkgdoc hex_dump_test
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "tests.h"
+#include "hex_dump.h"
+#include <QByteArray>
+#include <QString>
+#include <QTextStream>
+#include <QElapsedTimer>
+/*----------------------------------------------------------------------------*/
+/**
+ * Previous QTextStream based implementation, reference for hexDump() output.
+ */
+static QString hexDumpStream(const QByteArray& data, Codepage::Id codepage) {
+  if (data.isEmpty()) {
+    return QString();
+  }
+
+  QString output;
+  QTextStream stream(&output);
+  const int bytesPerRow = 16;
+  int dataSize = data.size();
+
+  for (int i = 0; i < dataSize; i += bytesPerRow) {
+    // 1. Output the offset (address)
+    // Format: 8-digit hex number, padded with zero.
+    stream << QString("%1: ").arg(i, 4, 16, QChar('0')).toUpper();
+
+    // Temporary strings for the two sections of the row
+    QString hexSection;
+    QString asciiSection;
+
+    // 2. Iterate through the 16 bytes (or fewer for the last row)
+    for (int j = 0; j < bytesPerRow; ++j) {
+      int currentPos = i + j;
+
+      if (currentPos < dataSize) {
+        char byte = data.at(currentPos);
+        unsigned char ubyte = (unsigned char)byte;
+
+        // Hex Section: Two-digit hex number, space separated
+        hexSection.append(QString("%1 ").arg(ubyte, 2, 16, QChar('0')).toUpper());
+
+        // ASCII Section: Convert to ASCII char or dot '.'
+        if (ubyte >= 0x20 && ubyte < 0x7F) {
+          // Printable ASCII character
+          asciiSection.append(QChar(byte));
+        } else if (ubyte >= 0x80 && codepage != Codepage::Utf8 && QChar::isPrint(Codepage::decode(codepage, ubyte))) {
+          // Upper half of single byte codepage
+          asciiSection.append(QChar(Codepage::decode(codepage, ubyte)));
+        } else {
+          // Non-printable character (control or outside 7-bit ASCII)
+          asciiSection.append('.');
+        }
+      } else {
+        // Pad short rows with spaces in the hex section
+        hexSection.append("   ");
+      }
+
+      // Add an extra space after the 8th byte for readability (optional, but standard)
+      if (j == 7) {
+        hexSection.append(" ");
+      }
+    }
+
+    // 3. Combine sections and write to the output stream
+    // Hex section is left-aligned, followed by a separator and ASCII section.
+    stream << hexSection.leftJustified((bytesPerRow * 3) + 1, ' ') << " " << asciiSection << "\n";
+  }
+
+  return output;
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Same output as previous implementation: short last row, 5 digit offsets, codepages.
+ * Benchmark prints demo dumps and compares speed of both implementations.
+ */
+bool hexDumpTest(bool benchmark) {
+  // Example data including hex bytes, strings, control characters (0A, 0D), and non-ASCII (E0)
+  QByteArray demoData;
+  // Row 1: 16 bytes of data
+  demoData.append(QByteArray::fromHex("50617273696E67206461746120616E64")); // 'Parsing data and'
+  // Row 2: Contains control chars (0A, 0D, 00, 7F), and non-ASCII (E0)
+  demoData.append(QByteArray::fromHex("0A0D007F207E4279746573212121E0")); // CR, LF, NULL, DEL, Space, ~, Bytes!!!, E0
+  // Row 3: Short row
+  demoData.append(QByteArray::fromHex("010203"));
+
+  QByteArray data(1024 * 1024 + 7, Qt::Uninitialized);
+  quint32 seed = 1;
+  for(int i = 0; i < data.size(); i++) {
+    seed = seed * 1103515245 + 12345;
+    data[i] = static_cast<char>(seed >> 24);
+  }
+  bool same = true;
+  for(int id = 0; id < Codepage::COUNT; id++) {
+    Codepage::Id codepage = static_cast<Codepage::Id>(id);
+    same = same && hexDump(data, codepage) == hexDumpStream(data, codepage)
+        && hexDump(demoData, codepage) == hexDumpStream(demoData, codepage);
+  }
+  bool ok = check("Hex dump compare:", same && hexDump(QByteArray()).isEmpty());
+  if(!benchmark) {
+    return ok;
+  }
+
+  qDebug() << "---------------------------------";
+  qDebug() << "Generated Hex Dump Test Output:";
+  // Output the resulting hex dump string directly, using noquote() to maintain formatting
+  qDebug().noquote() << hexDump(demoData);
+  qDebug() << "---------------------------------";
+  qDebug().noquote() << hexDumpRows<32, 4>(demoData, Codepage::Cp866);
+
+  double megabytes = data.size() / 1e6;
+  QElapsedTimer timer;
+  timer.start();
+  int length = hexDumpStream(data, Codepage::Utf8).size();
+  double streamSpeed = megabytes / (timer.nsecsElapsed() / 1e9);
+  timer.restart();
+  const int repeat = 20;
+  for(int i = 0; i < repeat; i++) {
+    length += hexDump(data, Codepage::Utf8).size();
+  }
+  double tableSpeed = repeat * megabytes / (timer.nsecsElapsed() / 1e9);
+  qDebug() << "Hex dump stream:" << streamSpeed << "MB/s";
+  qDebug() << "Hex dump table:" << tableSpeed << "MB/s," << tableSpeed / streamSpeed << "times faster" << length;
+  return ok;
+}
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,106 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg script_cache_test
+*/
+/**
+* Round trip of compiled scripts through on-disk cache.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 19.10.2026 10:20:00<br>
+* @pkgdoc script_cache_test
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "tests.h"
+#include "script_cache.h"
+#include <QFile>
+#include <QStandardPaths>
+#include <functional>
+#include <string.h>
+/*----------------------------------------------------------------------------*/
+static bool sameNodes(const CompiledScript& a, const CompiledScript& b) {
+  if(a.nodes.size() != b.nodes.size()) {
+    return false;
+  }
+  for(int i = 0; i < a.nodes.size(); i++) {
+    const ScriptNode& x = a.nodes[i];
+    const ScriptNode& y = b.nodes[i];
+    if(x.type != y.type || x.size != y.size || x.repeat != y.repeat || x.first != y.first || x.last != y.last
+       || x.step != y.step || x.bigEndian != y.bigEndian || x.time != y.time
+       || ((x.type == ScriptNode::Bytes || x.type == ScriptNode::WaitFor)
+           && a.literals.mid(x.offset, x.size) != b.literals.mid(y.offset, y.size))) {
+      return false;
+    }
+  }
+  return true;
+}
+/*----------------------------------------------------------------------------*/
+/**File content changed by change(), returns false if it is still loaded*/
+static bool rejected(quint64 hash, qint64 sourceSize, const QByteArray& content,
+                     const std::function<void(QByteArray *)>& change) {
+  QByteArray bad = content;
+  change(&bad);
+  QFile file(ScriptCache::fileName(hash));
+  if(!file.open(QIODevice::WriteOnly) || file.write(bad) != bad.size()) {
+    return false;
+  }
+  file.close();
+  CompiledScript script;
+  return !ScriptCache::load(hash, sourceSize, &script);
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Script compiled by parts is written to cache and loaded back the same,
+ * damaged cache files are not loaded.
+ */
+bool scriptCacheTest() {
+  //Cache of test mode, user cache is not touched
+  QStandardPaths::setTestModeEnabled(true);
+  QByteArray source = "1b 40 \"head\\r\\n\" u16le(0..999:3)*2 FF*5000 @delay 5ms 00..ff\n"
+                      "\"ab\"*300 @flush 0d 0a @wait-for \"OK\" 2s u32be(7)*3 \"tail\"\n";
+  int split = source.indexOf('\n') + 1;
+  CompiledScript whole, head, tail;
+  bool ok = parseFragment(QString::fromUtf8(source), ParserNormal, &whole) == ParserNormal
+      && parseFragment(QString::fromUtf8(source.left(split)), ParserNormal, &head) == ParserNormal
+      && parseFragment(QString::fromUtf8(source.mid(split)), ParserNormal, &tail) == ParserNormal;
+  quint64 hash = ScriptCache::hash(source.constData(), source.size(), 0x7e57);
+  ScriptCacheWriter writer;
+  ok = ok && writer.open(hash, source.size());
+  writer.append(head);
+  writer.append(tail);
+  ok = ok && writer.commit();
+
+  CompiledScript loaded;
+  ok = ok && ScriptCache::load(hash, source.size(), &loaded) && whole.hasCommands()
+      && sameNodes(whole, loaded) && loaded.toByteArray() == whole.toByteArray();
+  CompiledScript other;
+  ok = ok && !ScriptCache::load(hash, source.size() + 1, &other);
+  ok = check("Script cache round trip:", ok);
+  loaded = CompiledScript(); //File is not mapped while it is damaged
+
+  QFile file(ScriptCache::fileName(hash));
+  QByteArray content = file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+  file.close();
+  bool damaged = !content.isEmpty()
+      && rejected(hash, source.size(), content, [](QByteArray *data) {(*data)[0] = 'X';})
+      && rejected(hash, source.size(), content, [](QByteArray *data) {data->chop(8);})
+      && rejected(hash, source.size(), content, [](QByteArray *data) {data->truncate(16);})
+      && rejected(hash, source.size(), content, [](QByteArray *data) {
+        //Last node is literal bytes of zero size
+        ScriptNode node;
+        node.type = ScriptNode::Bytes;
+        node.size = 0;
+        memcpy(data->data() + data->size() - sizeof(node), &node, sizeof(node));
+      })
+      && rejected(hash, source.size(), content, [](QByteArray *data) {
+        ScriptNode node;
+        node.type = ScriptNode::Bytes;
+        node.offset = INT_MAX - 1;
+        node.size = 2;
+        memcpy(data->data() + data->size() - sizeof(node), &node, sizeof(node));
+      });
+  QFile::remove(ScriptCache::fileName(hash));
+  return check("Script cache damaged files:", damaged) && ok;
+}
+/*----------------------------------------------------------------------------*/
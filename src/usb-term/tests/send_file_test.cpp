@@ -0,0 +1,96 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg send_file_test
+*/
+/**
+* Script commands of sender against virtual device.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 19.10.2026 11:40:00<br>
+* @pkgdoc send_file_test
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "tests.h"
+#include "send_file.h"
+#include "virtual_transport.h"
+#include <QElapsedTimer>
+#include <thread>
+/*----------------------------------------------------------------------------*/
+/**
+ * Script is sent to echo device, received data is collected until sender is done
+ * and echo of the last data had time to come.
+ */
+static bool sendScript(VirtualTransport& transport, ScriptDataSender& sender, const QString& text, QByteArray *received) {
+  CompiledScript script;
+  if(parseFragment(text, ParserNormal, &script) != ParserNormal) {
+    return false;
+  }
+  sender.start(script);
+  QElapsedTimer timer;
+  timer.start();
+  qint64 done = -1;
+  while(timer.elapsed() < 5000 && (done < 0 || timer.elapsed() - done < 200)) {
+    TransportEvent event;
+    if(transport.poll(&event)) {
+      if(event.type == TransportEvent::Received) {
+        received->append(reinterpret_cast<const char *>(event.data.data()), static_cast<int>(event.data.size()));
+      }
+      continue;
+    }
+    if(done < 0 && sender.isFinished() && transport.pendingBytes() == 0) {
+      done = timer.elapsed();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return sender.isFinished();
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * @flush and @delay wait until device accepts previous data, @wait-for holds
+ * next data until answer comes, timeout stops sending. Timings of many commands
+ * are counted without keeping all of them.
+ */
+bool sendFileTest() {
+  VirtualTransport transport;
+  VirtualDeviceSettings settings;
+  settings.sinkRate = 200e3;
+  settings.latencyMs = 30;
+  transport.open(settings);
+  ScriptDataSender sender(&transport);
+  QByteArray received;
+  bool ok = sendScript(transport, sender, "\"A\"*20000 @flush @delay 10ms \"B\" @wait-for \"B\" 1s \"CCC\" @wait-for \"CC\" 1s \"D\"", &received)
+      && !sender.isError() && received == QByteArray(20000, 'A') + "BCCCD";
+  const auto& timings = sender.timings();
+  ok = ok && timings.size() == 4 && sender.commandCount() == 4
+      && timings[0].type == ScriptNode::Flush && timings[0].achieved >= 80000000
+      && timings[1].type == ScriptNode::Delay && timings[1].achieved >= timings[1].requested
+      //Echo of data sent after @delay comes after device latency
+      && timings[2].type == ScriptNode::WaitFor && !timings[2].timeout && timings[2].achieved >= 25000000
+      && timings[3].type == ScriptNode::WaitFor && !timings[3].timeout && timings[3].achieved >= 25000000;
+  ok = check("Script sender commands:", ok);
+
+  ScriptDataSender timeout(&transport);
+  received.clear();
+  bool stopped = sendScript(transport, timeout, "\"E\" @wait-for \"Z\" 50ms \"F\"", &received)
+      && timeout.isError() && timeout.message().startsWith("Timeout") && received == "E";
+  ok = check("Script sender timeout:", stopped) && ok;
+
+  settings.sinkRate = 0;
+  settings.latencyMs = 0;
+  transport.open(settings);
+  ScriptDataSender many(&transport);
+  QString delays;
+  for(int i = 0; i < FileSender::MAX_TIMINGS + 500; i++) {
+    delays += "01 @delay 0ms ";
+  }
+  received.clear();
+  bool counted = sendScript(transport, many, delays, &received) && !many.isError()
+      && received == QByteArray(FileSender::MAX_TIMINGS + 500, '\x01')
+      && many.timings().size() == static_cast<size_t>(FileSender::MAX_TIMINGS)
+      && many.commandCount() == FileSender::MAX_TIMINGS + 500
+      && many.timingReport().contains(QString("over %1 delays").arg(FileSender::MAX_TIMINGS + 500));
+  return check("Script sender timing limit:", counted) && ok;
+}
+/*----------------------------------------------------------------------------*/
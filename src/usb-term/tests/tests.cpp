@@ -0,0 +1,47 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg tests
+*/
+/**
+* Test runner: exit code is number of failed tests, so build and CI can fail on it.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 18.10.2026 10:00:00<br>
+* @pkgdoc tests
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "tests.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+/*----------------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+  QCoreApplication app(argc, argv);
+
+  QCommandLineParser parser;
+  parser.addHelpOption();
+  QCommandLineOption benchmarkOption("benchmark", QCoreApplication::translate("main", "Measure speed on large data after checks."));
+  parser.addOption(benchmarkOption);
+  QCommandLineOption soakOption("soak", QCoreApplication::translate("main", "Fill bounded capture store with <records>."), "records");
+  parser.addOption(soakOption);
+  parser.process(app);
+  bool benchmark = parser.isSet(benchmarkOption);
+
+  int failed = 0;
+  failed += !parseTest(benchmark);
+  failed += !crcTest(benchmark);
+  failed += !codepageTest(benchmark);
+  failed += !hexDumpTest(benchmark);
+  failed += !captureTest(benchmark);
+  failed += !transportTest(benchmark);
+  failed += !scriptCacheTest();
+  failed += !sendFileTest();
+  if(parser.isSet(soakOption)) {
+    failed += !captureSoakTest(parser.value(soakOption).toLongLong());
+  }
+  qDebug() << "Failed tests:" << failed;
+  return failed;
+}
+/*----------------------------------------------------------------------------*/
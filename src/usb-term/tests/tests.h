@@ -0,0 +1,38 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg tests
+*/
+/**
+* Self tests of usb-term modules. Each test returns false if any check failed,
+* speed is measured only in benchmark mode.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 18.10.2026 10:00:00<br>
+* @pkgdoc tests
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef TESTS_H_1792317600
+#define TESTS_H_1792317600
+/*----------------------------------------------------------------------------*/
+#include <QDebug>
+/*----------------------------------------------------------------------------*/
+/**Print "name PASS" or "name FAIL", returns ok*/
+inline bool check(const char *name, bool ok) {
+  qDebug() << name << (ok ? "PASS" : "FAIL");
+  return ok;
+}
+/*----------------------------------------------------------------------------*/
+bool parseTest(bool benchmark);
+bool crcTest(bool benchmark);
+bool codepageTest(bool benchmark);
+bool hexDumpTest(bool benchmark);
+bool captureTest(bool benchmark);
+/**Capture store under limit filled with given number of records*/
+bool captureSoakTest(qint64 records);
+bool transportTest(bool benchmark);
+bool scriptCacheTest();
+bool sendFileTest();
+/*----------------------------------------------------------------------------*/
+#endif /*TESTS_H_1792317600*/
@@ -0,0 +1,42 @@
+QT       += core
+QT       -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+# Self tests of non GUI modules: exit code is number of failed tests, "make check" runs them.
+# usb-term-tests --benchmark also measures speed on large data,
+# --soak <records> fills bounded capture store.
+TARGET = usb-term-tests
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    tests.cpp \
+    text_parser_test.cpp \
+    crc_test.cpp \
+    codepage_test.cpp \
+    hex_dump_test.cpp \
+    capture_store_test.cpp \
+    transport_test.cpp \
+    script_cache_test.cpp \
+    send_file_test.cpp \
+    ../text_parser.cpp \
+    ../crc.cpp \
+    ../codepage.cpp \
+    ../hex_dump.cpp \
+    ../capture_store.cpp \
+    ../script_cache.cpp \
+    ../send_file.cpp \
+    ../poll_transport.cpp \
+    ../chardev_transport.cpp \
+    ../tcp_transport.cpp \
+    ../pty_transport.cpp \
+    ../virtual_transport.cpp
+
+HEADERS += \
+    tests.h
+
+!win32 {
+    LIBS += -lpthread
+}
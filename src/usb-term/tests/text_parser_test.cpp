@@ -0,0 +1,292 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg text_parser_test
+*/
+/**
+* Checks of script lexer: escapes, generators, directives, checksums and parallel parsing.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 18.10.2026 10:00:00<br>
+* @pkgdoc text_parser_test
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "tests.h"
+#include "text_parser.h"
+#include <QByteArray>
+#include <QString>
+#include <QRegularExpression>
+#include <QElapsedTimer>
+#include <thread>
+/*----------------------------------------------------------------------------*/
+/**
+ * Previous regex based implementation, reference for parseText() on the syntax both handle the same way.
+ */
+static QByteArray parseTextRegex(const QString& text) {
+  QByteArray result;
+
+  QString inputText = text;
+
+  // Enum for capturing groups indices.
+  // Group 0 is the full match, so indexing starts from 1.
+  enum Group {
+    // NOTE: Group 1 is the full string token ("...")
+    STRING_CONTENT = 2,     // Group 2: The content of the string (without quotes)
+    COMMENT = 3,            // Group 3: The comment token (#.*)
+    HEX_BYTE = 4,           // Group 4: The hex byte token (1 or 2 chars)
+    DELIMITER = 5           // Group 5: The delimiter token (\s,+)
+  };
+
+  // Regex definition using five capturing groups (excluding Group 0 - full match):
+  // Group 1 & 2: String literal ("...") - Must be first for priority.
+  // Group 3: Comment (#.*)
+  // Group 4: Hex Byte (1 or 2 chars, e.g., 50, f, AA).
+  // Group 5: Delimiters (whitespace, comma).
+  QRegularExpression tokenRegex(
+        "(\"([^\"\\\\]*(?:\\\\.[^\"\\\\]*)*)\")"   // Group 1 (full string) & Group 2 (content)
+        "|(#.*)"                                  // Group 3 (COMMENT)
+        "|([0-9a-fA-F]{1,2})"                     // Group 4 (HEX_BYTE)
+        "|([\\s,]+)"                              // Group 5 (DELIMITER)
+        );
+
+  int offset = 0;
+  while (offset < inputText.length()) {
+    QRegularExpressionMatch match = tokenRegex.match(inputText, offset);
+
+    if (match.hasMatch() && match.capturedStart() == offset) {
+      offset = match.capturedEnd();
+
+      // Handle String literal (We check if Group 1, the full token, is not empty)
+      if (!match.captured(1).isEmpty()) {
+        // Use the enum for the content group index
+        QString content = match.captured(Group::STRING_CONTENT);
+
+        // Simple C-style escape sequences unescaping.
+        QString unescapedContent = content;
+        unescapedContent.replace("\\n", "\n");
+        unescapedContent.replace("\\t", "\t");
+        unescapedContent.replace("\\r", "\r");
+        unescapedContent.replace("\\a", "\a");
+        unescapedContent.replace("\\b", "\b");
+        unescapedContent.replace("\\f", "\f");
+        unescapedContent.replace("\\0", "\0");
+        unescapedContent.replace("\\\"", "\"");
+        unescapedContent.replace("\\\'", "\'");
+        unescapedContent.replace("\\\\", "\\");
+
+        // Append unescaped string as UTF-8 bytes
+        result.append(unescapedContent.toUtf8());
+
+        // Handle Comment (Group 3)
+      } else if (!match.captured(Group::COMMENT).isEmpty()) {
+        // Ignore the comment, offset is already advanced.
+
+        // Handle Hexadecimal byte (Group 4)
+      } else if (!match.captured(Group::HEX_BYTE).isEmpty()) {
+        QString hexByte = match.captured(Group::HEX_BYTE);
+        bool ok;
+        // Convert 1 or 2-char hex string to an 8-bit unsigned integer (byte)
+        char byteValue = hexByte.toUShort(&ok, 16);
+
+        if (ok) {
+          result.append(byteValue);
+        } else {
+          qWarning() << "Parsing error for hex byte:" << hexByte;
+        }
+
+        // Handle Delimiters (Group 5)
+      } else if (!match.captured(Group::DELIMITER).isEmpty()) {
+        // Ignore delimiters, just advance the offset
+      }
+    } else {
+      // Unexpected character or unrecognised token at current position
+      QString errorSnippet = inputText.mid(offset, 10);
+      qWarning() << "Syntax error at position" << offset << ". Unexpected text:" << errorSnippet << "...";
+      break;
+    }
+  }
+
+  return result;
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Check escapes, generators, checksums, fragments and parallel parsing, compare with
+ * regex implementation. Benchmark compares speed on big script and scaling with threads.
+ */
+bool parseTest(bool benchmark) {
+  struct {
+    const char *text;
+    QByteArray expected;
+  } cases[] = {
+    {"01 2 ab,CD", QByteArray::fromHex("0102abcd")},
+    {"abc # comment \"x\"\n 0d", QByteArray::fromHex("ab0c0d")},
+    {"\"a\\\\nb\"", QByteArray("a\\nb")},
+    {"\"\\x1b@\\x0\\101\\0\\e\"", QByteArray("\x1b@\x00" "A\x00\x1b", 6)},
+    {"\"\\q\\\"\\'\"", QByteArray("\\q\"'")},
+    {"\"multi\nline\" FF", QByteArray("multi\nline\xff")},
+    {"FF*4 0*0 1*1", QByteArray::fromHex("ffffffff01")},
+    {"\"AB\"*3 00", QByteArray("ABABAB\x00", 7)},
+    {"01..04 0a..08*2", QByteArray::fromHex("010203040a09080a0908")},
+    {"u8(7) u16le(0x1234) u16be(4660) u32le(1) u32be(0x01020304)", QByteArray::fromHex("07341212340100000001020304")},
+    {"u16be(1..5:2) u8(3..0:2)", QByteArray::fromHex("000100030005" "0301")},
+    {"u8(1..2)*2*3", QByteArray::fromHex("010201020102010201020102")},
+    {"\"123456789\" {crc16:0..8} {crc32:0..8}", QByteArray("123456789\x29\xb1\x26\x39\xf4\xcb")},
+    {"FF\n02 \"123456789\" 03 {crc16le:1..9} {xor:0..}", QByteArray("\xff\x02" "123456789\x03\xb1\x29\xa8")},
+    {"01 {crc16:0..5}", QByteArray::fromHex("01")},
+    {"@codepage cp866 \"\u0422\u0435\u0441\u0442\" @codepage CP1251 \"\u0422\" @codepage utf8 \"\u0422\"", QByteArray("\x92\xa5\xe1\xe2" "\xd2" "\xd0\xa2")},
+    {"01 @delay 5ms 02 @flush @wait-for \"\\x12\" 100ms 03 @wait-for \"OK\"", QByteArray::fromHex("010203")},
+  };
+  int failed = 0;
+  for(const auto& item : cases) {
+    QByteArray data = parseText(QString::fromUtf8(item.text));
+    if(data != item.expected) {
+      failed++;
+      qDebug() << "FAIL" << item.text << data.toHex(' ') << "expected" << item.expected.toHex(' ');
+    }
+  }
+  qDebug() << "Parser cases:" << (sizeof(cases) / sizeof(cases[0])) << "failed:" << failed;
+  bool ok = failed == 0;
+
+  //Line by line parsing with state carried must give the same data
+  QString multiline = "1b 40 \"first\n  second \\\"quoted\\\"\n third\" 0a\n\"\\x41\" # \"\n0d\n\"open\nstring";
+  QByteArray joined;
+  ParserState state = ParserNormal;
+  int openString = -1;
+  for(int pos = 0; pos < multiline.size();) {
+    int next = multiline.indexOf('\n', pos);
+    next = next < 0 ? multiline.size() : next + 1;
+    int base = joined.size();
+    int stringStart = -1;
+    state = parseFragment(multiline.mid(pos, next - pos), state, &joined, &stringStart);
+    if(stringStart >= 0) {
+      openString = base + stringStart;
+    }
+    pos = next;
+  }
+  if(state == ParserInString) {
+    joined.resize(openString);
+  }
+  ok = check("Fragments:", joined == parseText(multiline)) && ok;
+  //String closed in fragment is not open: -1 from both lexers
+  QByteArray closed;
+  int closedStart = 0;
+  int parallelStart = 0;
+  parseFragment("01 \"ab\" 02", ParserNormal, &closed, &closedStart);
+  parseParallel("01 \"ab\" 02", ParserNormal, &closed, &parallelStart);
+  ok = check("Closed string:", closedStart == -1 && parallelStart == -1) && ok;
+
+  //Generator nodes must expand to the same data
+  QString generators = "1b \"x\"*3 FF*5000 u16le(0..999:3)*2 \"ab\\n\"*2000 00..ff u32be(7)*3 \"\ntail\"";
+  CompiledScript compiled;
+  parseFragment(generators, ParserNormal, &compiled);
+  QByteArray expanded;
+  compiled.expand([&](const QByteArray& chunk) {
+    expanded.append(chunk);
+    return true;
+  }, 1000);
+  CompiledScript timed;
+  parseFragment("1b @delay 50ms @flush @wait-for \"\\x12\" 2s 0d", ParserNormal, &timed);
+  bool timedOk = timed.nodes.size() == 5 && timed.nodes[1].type == ScriptNode::Delay && timed.nodes[1].time == 50000000
+      && timed.nodes[3].type == ScriptNode::WaitFor && timed.nodes[3].time == 2000000000LL
+      && timed.literals.mid(timed.nodes[3].offset, timed.nodes[3].size) == QByteArray("\x12")
+      && timed.toByteArray() == QByteArray::fromHex("1b0d");
+  ok = check("Directives:", timedOk) && ok;
+
+  //Checksums over generator output must match expanded parsing
+  QString checksums = "AA 31..39 {crc16:1..}\n\"ab\"*3 u16be(1..3) {crc32:2..9} {xor:0..}\n\"x\ny\" FF*3 {crc16:0..}\n"
+                      "AA\nBB u8(1..2) {crc16:0..}";
+  CompiledScript checked;
+  parseFragment(checksums, ParserNormal, &checked);
+  bool checksumsOk = checked.toByteArray() == parseText(checksums);
+  //Repeated multiline string has no defined checksum line: both lexers reject it
+  const char *multilineRepeats[] = {
+    "01 \"x\ny\" *2 {xor:0..}",
+    "\"x\ny\" *2 FF {xor:0..1}",
+    "\"x\ny\" *0 u8(1..2) {xor:0..1}"
+  };
+  for(auto text : multilineRepeats) {
+    QByteArray bytes;
+    CompiledScript script;
+    checksumsOk = checksumsOk && parseFragment(text, ParserNormal, &bytes) == ParserError
+        && parseFragment(text, ParserNormal, &script) == ParserError;
+  }
+  ok = check("Checksums:", checksumsOk) && ok;
+  //Empty string repeated gives nothing, also in compiled script and checksum of its line
+  QString emptyRepeat = "01 \"\"*5 02 \"\"*0 \"\"*4000000000 {xor:0..}";
+  CompiledScript empty;
+  parseFragment(emptyRepeat, ParserNormal, &empty);
+  ok = check("Empty repeat:", parseText(emptyRepeat) == QByteArray::fromHex("010203") && empty.toByteArray() == QByteArray::fromHex("010203")) && ok;
+  qDebug() << "Generators:" << compiled.nodes.size() << "nodes," << compiled.literals.size() << "literal bytes," << compiled.size() << "bytes";
+  ok = check("Generators:", expanded == parseText(generators) && compiled.size() == quint64(expanded.size())) && ok;
+
+  //Script with the features both implementations handle the same way
+  QString line = "1B 40 1d,21 00 \"Receipt line\\t\\\"total\\\"\\r\\n\" 0a # feed\n"
+                 "\"\u0422\u0435\u043a\u0441\u0442 \u2116 12\" 0D 0A\n";
+  QString script;
+  while(script.size() < (benchmark ? 4 * 1024 * 1024 : 64 * 1024)) {
+    script += line;
+  }
+  double megabytes = script.size() * sizeof(QChar) / 1e6;
+
+  QElapsedTimer timer;
+  timer.start();
+  QByteArray fast = parseText(script);
+  qint64 fastNs = timer.nsecsElapsed();
+
+  timer.restart();
+  QByteArray slow = parseTextRegex(script);
+  qint64 slowNs = timer.nsecsElapsed();
+
+  ok = check("Regex reference:", fast == slow) && ok;
+  if(benchmark) {
+    qDebug() << "Script" << megabytes << "MB of UTF-16 text, output" << fast.size() << "bytes";
+    qDebug() << "Lexer:" << megabytes / (fastNs / 1e9) << "MB/s";
+    qDebug() << "Regex:" << megabytes / (slowNs / 1e9) << "MB/s";
+  }
+
+  //Parallel parsing: strings, comments with quotes and codepages cross segment bounds
+  QString tricky = "01 \"multi\nline # not comment\n\" 02 # comment \"\n\"\\\"\n\" u8(1..9)*2\n"
+                   "\"\u0422 @codepage cp1251\" # @codepage cp437\n@codepage cp866 \"\u0422\"\n\"\u0422\nx\" @codepage utf8\n";
+  QString big;
+  while(big.size() < 2 * 1024 * 1024) {
+    big += tricky;
+  }
+  big += "\"open\nstring";
+  QByteArray sequential;
+  int sequentialOpen = -1;
+  ParserState sequentialState = parseFragment(big, ParserNormal, &sequential, &sequentialOpen);
+  QByteArray parallel;
+  int parallelOpen = -1;
+  ParserState parallelState = parseParallel(big, ParserNormal, &parallel, &parallelOpen, nullptr, 8);
+  CompiledScript parallelScript;
+  parseParallel(big, ParserNormal, &parallelScript, nullptr, nullptr, 8);
+  ok = check("Parallel:", parallel == sequential && parallelState == sequentialState && parallelOpen == sequentialOpen
+             && parallelScript.toByteArray() == sequential) && ok;
+  if(!benchmark) {
+    return ok;
+  }
+
+  //Scaling with thread count
+  QString huge;
+  while(huge.size() < 32 * 1024 * 1024) {
+    huge += script;
+  }
+  double hugeMegabytes = huge.size() * sizeof(QChar) / 1e6;
+  QByteArray reference;
+  timer.restart();
+  parseFragment(huge, ParserNormal, &reference);
+  qint64 sequentialNs = timer.nsecsElapsed();
+  qDebug() << "Cores:" << static_cast<int>(std::thread::hardware_concurrency()) << ", sequential:" << hugeMegabytes / (sequentialNs / 1e9) << "MB/s";
+  for(int threads : {1, 2, 4, 8, 16, static_cast<int>(std::thread::hardware_concurrency())}) {
+    QByteArray data;
+    timer.restart();
+    parseParallel(huge, ParserNormal, &data, nullptr, nullptr, threads);
+    qint64 ns = timer.nsecsElapsed();
+    qDebug() << "Threads" << threads << ":" << hugeMegabytes / (ns / 1e9) << "MB/s, speedup"
+             << double(sequentialNs) / ns << ", same result:" << (data == reference);
+    ok = ok && data == reference;
+  }
+  return ok;
+}
+/*----------------------------------------------------------------------------*/
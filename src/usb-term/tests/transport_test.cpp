@@ -0,0 +1,296 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg transport_test
+*/
+/**
+* Loopback checks of poll() driven transports against local stand-ins.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 18.10.2026 12:00:00<br>
+* @pkgdoc transport_test
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "tests.h"
+#include "chardev_transport.h"
+#include "tcp_transport.h"
+#include "pty_transport.h"
+#include "virtual_transport.h"
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <functional>
+#include <string.h>
+#include <thread>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <termios.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+/*----------------------------------------------------------------------------*/
+/**
+ * Events of transport are passed to done() until it returns true.
+ * Returns false on timeout.
+ */
+static bool waitFor(Transport& transport, const std::function<bool(const TransportEvent&)>& done, int timeoutMs = 2000) {
+  QElapsedTimer timer;
+  timer.start();
+  TransportEvent event;
+  while(timer.elapsed() < timeoutMs) {
+    if(!transport.poll(&event)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      continue;
+    }
+    if(done(event)) {
+      return true;
+    }
+  }
+  return false;
+}
+/*----------------------------------------------------------------------------*/
+/**Data received until it has size bytes*/
+static bool receive(Transport& transport, std::vector<uint8_t> *data, size_t size) {
+  return data->size() >= size || waitFor(transport, [&](const TransportEvent& event) {
+    if(event.type == TransportEvent::Received) {
+      data->insert(data->end(), event.data.begin(), event.data.end());
+    }
+    return data->size() >= size;
+  });
+}
+/*----------------------------------------------------------------------------*/
+/**Data read from other end of connection until it has size bytes*/
+static bool readPeer(int fd, std::vector<uint8_t> *data, size_t size, int timeoutMs = 2000) {
+  QElapsedTimer timer;
+  timer.start();
+  uint8_t buffer[4096];
+  while(data->size() < size && timer.elapsed() < timeoutMs) {
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if(::poll(&pfd, 1, 10) <= 0) {
+      continue;
+    }
+    ssize_t r = ::read(fd, buffer, sizeof(buffer));
+    if(r <= 0 && errno != EAGAIN && errno != EINTR) {
+      return false;
+    }
+    if(r > 0) {
+      data->insert(data->end(), buffer, buffer + r);
+    }
+  }
+  return data->size() >= size;
+}
+/*----------------------------------------------------------------------------*/
+static bool waitEvent(Transport& transport, TransportEvent::Type type) {
+  return waitFor(transport, [type](const TransportEvent& event) {return event.type == type;});
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * FIFO opened for read and write by transport returns written data,
+ * data of other writer is received too.
+ */
+static bool fifoTest(bool benchmark) {
+  QTemporaryDir dir;
+  std::string path = dir.filePath("fifo").toStdString();
+  CharDeviceTransport transport;
+  bool missing = !transport.open(path) && transport.isError() && !transport.isOpened();
+  if(!dir.isValid() || mkfifo(path.c_str(), 0600) < 0) {
+    return check("FIFO transport: can not create FIFO", false);
+  }
+  bool ok = missing && transport.open(path);
+
+  const uint8_t data[] = {'h', 'e', 'l', 'l', 'o', 0, 0xff, '\n'};
+  std::vector<uint8_t> received;
+  bool written = false;
+  ok = ok && transport.write(data, sizeof(data)) == sizeof(data)
+      && waitFor(transport, [&](const TransportEvent& event) {
+        if(event.type == TransportEvent::Received) {
+          received.insert(received.end(), event.data.begin(), event.data.end());
+        }
+        written = written || (event.type == TransportEvent::Written && event.length == sizeof(data));
+        return written && received.size() >= sizeof(data);
+      })
+      && received == std::vector<uint8_t>(data, data + sizeof(data));
+
+  int writer = ::open(path.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+  received.clear();
+  ok = ok && writer >= 0 && ::write(writer, "abc", 3) == 3 && receive(transport, &received, 3)
+      && received == std::vector<uint8_t>{'a', 'b', 'c'};
+  if(writer >= 0) {
+    ::close(writer);
+  }
+  ok = check("FIFO transport:", ok);
+  if(!benchmark || !ok) {
+    return ok;
+  }
+
+  const size_t size = 16 * 1024 * 1024;
+  std::vector<uint8_t> block(size, 0x55);
+  received.clear();
+  received.reserve(size);
+  QElapsedTimer timer;
+  timer.start();
+  transport.write(block.data(), block.size());
+  ok = receive(transport, &received, size);
+  qDebug() << "FIFO loopback:" << size / 1e6 / (timer.nsecsElapsed() / 1e9) << "MB/s";
+  return check("FIFO loopback:", ok && received == block);
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Client of local listener: data both ways, reconnect after peer closed
+ * connection with data queued meanwhile, close() while reconnect is pending.
+ */
+static bool tcpTest() {
+  int listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t length = sizeof(address);
+  //Backlog 0: one connection waits for accept(), next ones stay in progress
+  if(listener < 0 || bind(listener, reinterpret_cast<struct sockaddr *>(&address), length) < 0 || listen(listener, 0) < 0
+     || getsockname(listener, reinterpret_cast<struct sockaddr *>(&address), &length) < 0) {
+    if(listener >= 0) {
+      ::close(listener);
+    }
+    return check("TCP transport: can not listen", false);
+  }
+  TcpTransport transport;
+  TcpSettings settings;
+  settings.host = "127.0.0.1";
+  settings.port = ntohs(address.sin_port);
+  bool ok = transport.open(settings);
+  int peer = ok ? accept(listener, nullptr, nullptr) : -1;
+  std::vector<uint8_t> received;
+  ok = ok && peer >= 0 && transport.write("\x1b@", 2) == 2 && readPeer(peer, &received, 2)
+      && received == std::vector<uint8_t>{0x1b, '@'};
+  received.clear();
+  ok = ok && ::write(peer, "\x10\x04\x01", 3) == 3 && receive(transport, &received, 3)
+      && received == std::vector<uint8_t>{0x10, 0x04, 0x01};
+  bool exchange = ok;
+
+  if(peer >= 0) {
+    ::close(peer);
+  }
+  ok = ok && waitEvent(transport, TransportEvent::Detached)
+      && transport.write("queued", 6) == 6
+      && waitEvent(transport, TransportEvent::Attached);
+  peer = ok ? accept(listener, nullptr, nullptr) : -1;
+  received.clear();
+  ok = ok && peer >= 0 && readPeer(peer, &received, 6) && received == std::vector<uint8_t>{'q', 'u', 'e', 'u', 'e', 'd'};
+  bool reconnect = ok;
+
+  int other = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if(connect(other, reinterpret_cast<struct sockaddr *>(&address), length) < 0 && errno != EINPROGRESS) {
+    ok = false;
+  }
+  if(peer >= 0) {
+    ::close(peer);
+  }
+  ok = ok && waitEvent(transport, TransportEvent::Detached);
+  std::this_thread::sleep_for(std::chrono::milliseconds(800)); //Reconnect is started and waits for accept queue
+  QElapsedTimer timer;
+  timer.start();
+  ok = ok && transport.write("x", 1) == 1;
+  transport.close();
+  bool pending = ok && timer.elapsed() < PollTransport::OPEN_TIMEOUT_MS / 4;
+  ::close(other);
+  ::close(listener);
+  return check("TCP transport:", exchange && reconnect && pending);
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Program attached to slave side of pty gets data unchanged and answers.
+ */
+static bool ptyTest() {
+  PtyTransport transport;
+  bool ok = transport.open();
+  int slave = ok ? ::open(transport.slaveName().c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC) : -1;
+  const uint8_t data[] = {0x1b, '@', '\r', '\n', 0, 0x03, 0x7f, 0xff};
+  std::vector<uint8_t> received;
+  ok = ok && slave >= 0 && transport.write(data, sizeof(data)) == sizeof(data)
+      && readPeer(slave, &received, sizeof(data)) && received == std::vector<uint8_t>(data, data + sizeof(data));
+  received.clear();
+  ok = ok && ::write(slave, "\x10\x04\x01\n", 4) == 4 && receive(transport, &received, 4)
+      && received == std::vector<uint8_t>{0x10, 0x04, 0x01, '\n'};
+  if(slave >= 0) {
+    ::close(slave);
+  }
+  return check("Pty transport:", ok);
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Virtual device with echo: rate limit holds data in queue, every write
+ * is reported once, echo keeps order. Without rate limit writes are not
+ * blocked while device drains queue, echo waiting for latency stops it.
+ */
+static bool virtualTest() {
+  VirtualTransport transport;
+  VirtualDeviceSettings settings;
+  settings.sinkRate = 1e6;
+  settings.latencyMs = 2;
+  transport.open(settings);
+  std::vector<uint8_t> data(100000);
+  for(size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<uint8_t>(i * 7 + i / 251);
+  }
+  QElapsedTimer timer;
+  timer.start();
+  bool ok = transport.write(data.data(), 40000) == 40000
+      && transport.writeBuffer(TransportBuffer::copy(data.data() + 40000, 60000)) == 60000
+      && transport.pendingBytes() > 50000;
+  std::vector<uint8_t> received;
+  size_t written = 0;
+  ok = ok && waitFor(transport, [&](const TransportEvent& event) {
+    if(event.type == TransportEvent::Received) {
+      received.insert(received.end(), event.data.begin(), event.data.end());
+    }
+    written += event.type == TransportEvent::Written;
+    return written == 2 && received.size() >= data.size();
+  }) && received == data && transport.pendingBytes() == 0 && timer.elapsed() >= 80;
+  bool limited = check("Virtual transport rate limit:", ok);
+
+  settings.sinkRate = 0;
+  settings.latencyMs = 50;
+  transport.open(settings);
+  const size_t count = 128;
+  auto block = TransportBuffer::copy(data.data(), data.size());
+  timer.restart();
+  for(size_t i = 0; i < count; i++) {
+    ok = transport.writeBuffer(block) == static_cast<int>(block.size) && ok;
+  }
+  ok = ok && timer.elapsed() < 20;
+  //No echo is delivered yet: device has accepted no more than its echo limit
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  ok = ok && transport.pendingBytes() > count * data.size() / 2;
+  received.clear();
+  written = 0;
+  ok = ok && waitFor(transport, [&](const TransportEvent& event) {
+    if(event.type == TransportEvent::Received) {
+      received.insert(received.end(), event.data.begin(), event.data.end());
+    }
+    written += event.type == TransportEvent::Written;
+    return written == count && received.size() >= count * data.size();
+  }) && received.size() == count * data.size() && transport.pendingBytes() == 0;
+  for(size_t i = 0; ok && i < count; i++) {
+    ok = std::equal(data.begin(), data.end(), received.begin() + i * data.size());
+  }
+  return check("Virtual transport echo:", ok) && limited;
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Transports are checked without devices: a FIFO stands in for usblp,
+ * local listener for network printer, pty slave for printer emulator,
+ * in-memory virtual device for itself.
+ */
+bool transportTest(bool benchmark) {
+  bool ok = fifoTest(benchmark);
+  ok = tcpTest() && ok;
+  ok = ptyTest() && ok;
+  return virtualTest() && ok;
+}
+/*----------------------------------------------------------------------------*/
@@ -10,6 +10,11 @@
  * 2. Strings are enclosed in double quotes (") and support C-style escape sequences (\n, \t, \", \\).
  * 3. Delimiters are blank characters (spaces, tabs) and commas.
  * 4. Individual words are two-character hexadecimal bytes (e.g., '5A', 'ff') without '0x' or 'h'.
+ * 5. Generators: byte range (00..FF), typed numbers and counters (u16le(1000), u32be(0..99:3))
+ *    and repeat of previous item (FF*4096, "ABC"*100).
+ * 6. Directives: @delay 50ms, @flush, @wait-for "\x12" 500ms.
+ * 7. Checksum fields over bytes of the line: {crc16:0..5}, {crc32le:2..}, {xor:1..}.
+ * 8. @codepage cp866: codepage of following strings (utf8, cp437, cp866, cp1251).
 * (C) T&T, Kiev, Ukraine 2025.<br>
 * started 29.10.2025 10:38:36<br>
 * @pkgdoc text_highlighter
@@ -23,6 +28,8 @@
 #include <QRegularExpression>
 #include <QTextCharFormat>
 #include <QPlainTextEdit>
+#include <QTextBlock>
+#include <QTextDocument>
 #include <QBrush>
 #include <QColor>
 #include <QtDebug>
@@ -44,6 +51,12 @@ void TextHighlighter::setupRules()
   // --- 3. Формат для рядків ---
   stringFormat.setForeground(QColor("#0548ff")); // Blue
   stringFormat.setFontWeight(QFont::Bold);
+  // --- 4. Generators format ---
+  generatorFormat.setForeground(QColor("#a0309a")); // Magenta
+  generatorFormat.setFontWeight(QFont::Bold);
+  // --- 5. Directives format ---
+  directiveFormat.setForeground(QColor("#b05a00")); // Brown
+  directiveFormat.setFontWeight(QFont::Bold);
 
   // 1. Коментарі (#...)
   commentRules.append({QRegularExpression("#.*$"), commentFormat});
@@ -52,6 +65,17 @@ void TextHighlighter::setupRules()
   // Використовуємо \\b для точного виділення токенів
   singleLineRules.append({QRegularExpression("\\b[0-9a-fA-F]{1,2}\\b"), hexByteFormat});
 
+  // 3. Generators: after hex bytes to override digits inside them
+  singleLineRules.append({QRegularExpression("\\b[0-9a-fA-F]{1,2}\\.\\.[0-9a-fA-F]{1,2}\\b"), generatorFormat});
+  singleLineRules.append({QRegularExpression("\\bu(8|16[lb]e|32[lb]e)\\([^)\"]*\\)"), generatorFormat});
+  singleLineRules.append({QRegularExpression("\\*[ \\t]*(0[xX][0-9a-fA-F]+|[0-9]+)"), generatorFormat});
+  singleLineRules.append({QRegularExpression("\\{[ \\t]*(crc16|crc32|xor)(le|be)?[ \\t]*:[^}\"]*\\}"), generatorFormat});
+
+  // 4. Directives and their time arguments
+  singleLineRules.append({QRegularExpression("@(delay|flush|wait-for)\\b"), directiveFormat});
+  singleLineRules.append({QRegularExpression("@codepage[ \\t]+[A-Za-z0-9-]+"), directiveFormat});
+  singleLineRules.append({QRegularExpression("\\b[0-9]+(us|ms|s)\\b"), directiveFormat});
+
   // --- Регулярні вирази для БАГАТОРЯДКОВИХ об'єктів ---
 
   // Для початку і кінця багаторядкового рядка достатньо простої лапки
@@ -59,6 +83,69 @@ void TextHighlighter::setupRules()
 }
 
 void TextHighlighter::highlightBlock(const QString &text)
+{
+  formatBlock(text);
+  compileBlock(text);
+}
+
+void TextHighlighter::compileBlock(const QString &text)
+{
+  auto data = static_cast<ScriptBlockData *>(currentBlockUserData());
+  if(!data) {
+    data = new ScriptBlockData;
+    setCurrentBlockUserData(data);
+  }
+  data->script = CompiledScript();
+  int previous = previousBlockState();
+  data->startState = isInString(previous) ? ParserInString : ParserNormal;
+  data->startCodepage = previous >= 0 ? static_cast<Codepage::Id>(previous >> CODEPAGE_SHIFT) : m_codepage;
+  data->codepage = data->startCodepage;
+  data->newline = currentBlock().next().isValid();
+  data->state = parseFragment(data->newline ? text + QChar('\n') : text, data->startState, &data->script, &data->stringStart,
+                              &data->codepage);
+  //Lexer state is used for strings continuation: it knows escaped quotes.
+  //Codepage is kept in state too, so @codepage change rehighlights next blocks
+  setCurrentBlockState((data->state == ParserInString ? InString : 0) | data->codepage << CODEPAGE_SHIFT);
+}
+
+void TextHighlighter::setCodepage(Codepage::Id codepage)
+{
+  if(codepage != m_codepage) {
+    m_codepage = codepage;
+    rehighlight();
+  }
+}
+
+CompiledScript TextHighlighter::compiledScript()
+{
+  CompiledScript result;
+  ParserState state = ParserNormal;
+  Codepage::Id codepage = m_codepage;
+  int openString = -1;
+  for(QTextBlock block = document()->begin(); block.isValid(); block = block.next()) {
+    auto data = static_cast<ScriptBlockData *>(block.userData());
+    if(!data || data->startState != state || data->startCodepage != codepage || data->newline != block.next().isValid()) {
+      rehighlightBlock(block);
+      data = static_cast<ScriptBlockData *>(block.userData());
+    }
+    if(data->state == ParserInString && data->stringStart >= 0) {
+      openString = result.literals.size() + data->stringStart;
+    }
+    result.append(data->script);
+    if(data->state == ParserError) {
+      return result;
+    }
+    state = data->state;
+    codepage = data->codepage;
+  }
+  if(state == ParserInString) {
+    qWarning() << "Syntax error: unterminated string";
+    result.splitTail(openString);
+  }
+  return result;
+}
+
+void TextHighlighter::formatBlock(const QString &text)
 {
   setCurrentBlockState(NormalState);
   int startIndex = 0;
@@ -67,7 +154,7 @@ void TextHighlighter::highlightBlock(const QString &text)
   // -----------------------------------------------------------
   // 1. Обробка продовження багаторядкового рядка (InString)
   // -----------------------------------------------------------
-  if (previousBlockState() == InString) {
+  if (isInString(previousBlockState())) {
     // Рядок почався у попередньому блоці. Підсвічуємо з самого початку.
     startIndex = 0;
     // Шукаємо закриваючу лапку
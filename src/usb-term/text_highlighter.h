@@ -10,6 +10,11 @@
  * 2. Strings are enclosed in double quotes (") and support C-style escape sequences (\n, \t, \", \\).
  * 3. Delimiters are blank characters (spaces, tabs) and commas.
  * 4. Individual words are two-character hexadecimal bytes (e.g., '5A', 'ff') without '0x' or 'h'.
+ * 5. Generators: byte range (00..FF), typed numbers and counters (u16le(1000), u32be(0..99:3))
+ *    and repeat of previous item (FF*4096, "ABC"*100).
+ * 6. Directives: @delay 50ms, @flush, @wait-for "\x12" 500ms.
+ * 7. Checksum fields over bytes of the line: {crc16:0..5}, {crc32le:2..}, {xor:1..}.
+ * 8. @codepage cp866: codepage of following strings (utf8, cp437, cp866, cp1251).
 * (C) T&T, Kiev, Ukraine 2025.<br>
 * started 29.10.2025 10:38:36<br>
 * @pkgdoc text_highlighter
@@ -21,9 +26,25 @@
 #define TEXT_HIGHLIGHTER_H_1761727116
 /*----------------------------------------------------------------------------*/
 #include <QSyntaxHighlighter>
+#include <QTextBlockUserData>
 #include <QRegularExpression>
 #include <QObject>
 #include <QVector>
+#include "text_parser.h"
+
+/**
+ * Compiled data of one text block (line with line feed).
+ */
+struct ScriptBlockData : public QTextBlockUserData
+{
+  CompiledScript script;
+  ParserState startState = ParserNormal;
+  ParserState state = ParserNormal; //State at block end
+  Codepage::Id startCodepage = Codepage::Utf8;
+  Codepage::Id codepage = Codepage::Utf8; //Codepage at block end
+  int stringStart = -1;             //Offset in literals of string not closed in this block
+  bool newline = false;             //Line feed was compiled
+};
 
 class TextHighlighter : public QSyntaxHighlighter
 {
@@ -31,6 +52,15 @@ class TextHighlighter : public QSyntaxHighlighter
 
 public:
   TextHighlighter(QTextDocument *parent = nullptr);
+  /**
+   * Script of the whole document from blocks compiled by highlightBlock().
+   * Only blocks not compiled yet are parsed. Generators are not expanded.
+   */
+  CompiledScript compiledScript();
+  QByteArray compiledData() {return compiledScript().toByteArray();}
+  /**Codepage of strings until the first @codepage of document*/
+  Codepage::Id codepage() const {return m_codepage;}
+  void setCodepage(Codepage::Id codepage);
 
 protected:
   void highlightBlock(const QString &text) override;
@@ -38,8 +68,11 @@ protected:
 private:
   enum {
     NormalState = -1, // Стандартний стан
-    InString = 1      // Стан "Всередині багаторядкового рядка"
+    InString = 1,     // Стан "Всередині багаторядкового рядка"
+    CODEPAGE_SHIFT = 1 //Compiled block state: InString bit and codepage above it
   };
+  Codepage::Id m_codepage = Codepage::Utf8;
+  static bool isInString(int blockState) {return blockState >= 0 && (blockState & InString);}
 
   struct HighlightingRule
   {
@@ -54,7 +87,11 @@ private:
   QTextCharFormat stringFormat;
   QTextCharFormat commentFormat;
   QTextCharFormat hexByteFormat;
+  QTextCharFormat generatorFormat;
+  QTextCharFormat directiveFormat;
   void setupRules();
+  void formatBlock(const QString &text);
+  void compileBlock(const QString &text);
 };
 /*----------------------------------------------------------------------------*/
 #endif /*TEXT_HIGHLIGHTER_H_1761727116*/
@@ -13,107 +13,1246 @@
 */
 /*----------------------------------------------------------------------------*/
 #include "text_parser.h"
+#include "crc.h"
 /*----------------------------------------------------------------------------*/
 #include <QByteArray>
 #include <QString>
-#include <QRegularExpression>
 #include <QDebug>
-
-#include <QByteArray>
-#include <QString>
-#include <QRegularExpression>
-#include <QDebug>
-
+#include <algorithm>
+#include <string.h>
+#include <thread>
+#include <atomic>
+#include <vector>
+/*----------------------------------------------------------------------------*/
+static inline int hexDigit(ushort c) {
+  if(c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  c |= 0x20;
+  if(c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+/*----------------------------------------------------------------------------*/
+static inline bool isDelimiter(ushort c) {
+  if(c < 0x80) {
+    return c == ' ' || c == ',' || (c >= '\t' && c <= '\r');
+  }
+  return QChar(c).isSpace();
+}
+/*----------------------------------------------------------------------------*/
 /**
- * @brief Parses a text block containing strings, hex bytes, delimiters, and comments.
- * * Comments (#) are handled during tokenization to prevent them from interfering
- * with string literals (e.g., "string # comment").
- * * @param text The input text block (QString).
- * @return QByteArray containing the parsed data (bytes from strings and hex values).
+ * Output buffer, appends to existing data. Sized for the whole text at start: every token gives
+ * at most one byte per source char except non ASCII chars in strings, repeats and counters.
  */
-QByteArray parseText(const QString& text) {
-  QByteArray result;
-
-  QString inputText = text;
-
-  // Enum for capturing groups indices.
-  // Group 0 is the full match, so indexing starts from 1.
-  enum Group {
-    // NOTE: Group 1 is the full string token ("...")
-    STRING_CONTENT = 2,     // Group 2: The content of the string (without quotes)
-    COMMENT = 3,            // Group 3: The comment token (#.*)
-    HEX_BYTE = 4,           // Group 4: The hex byte token (1 or 2 chars)
-    DELIMITER = 5           // Group 5: The delimiter token (\s,+)
+class ParserOutput {
+  QByteArray& buffer;
+  int base;
+  char *out;
+  char *end;
+  bool overflow = false;
+public:
+  enum {
+    MAX_SIZE = 1024 * 1024 * 1024 //Limit of expanded data
   };
+  ParserOutput(QByteArray& b, int size) : buffer(b) {
+    base = buffer.size();
+    buffer.resize(base + size);
+    out = buffer.data() + base;
+    end = buffer.data() + buffer.size();
+  }
+  ~ParserOutput() {
+    buffer.resize(position());
+  }
+  inline void put(char c) {
+    *out++ = c;
+  }
+  int position() const {
+    return static_cast<int>(out - buffer.constData());
+  }
+  /**Bytes added by this output*/
+  int written() const {
+    return position() - base;
+  }
+  inline void putValue(quint32 value, int size, bool bigEndian) {
+    for(int i = 0; i < size; i++) {
+      put(static_cast<char>(value >> ((bigEndian ? size - 1 - i : i) * 8)));
+    }
+  }
+  /**Data exceeded MAX_SIZE, output is not complete*/
+  bool overflowed() const {
+    return overflow;
+  }
+  /**Drop data after pos*/
+  void rewind(int pos) {
+    out = buffer.data() + pos;
+  }
+  /**Make room for size bytes and the rest of source text at one byte per char*/
+  bool reserve(qint64 size, ptrdiff_t remaining) {
+    if(end - out >= size + remaining) {
+      return true;
+    }
+    qint64 need = position() + size + remaining;
+    if(need > MAX_SIZE) {
+      return false;
+    }
+    int pos = position();
+    int newSize = static_cast<int>(std::min<qint64>(std::max<qint64>(need, buffer.size() * 2LL), MAX_SIZE));
+    buffer.resize(newSize);
+    out = buffer.data() + pos;
+    end = buffer.data() + newSize;
+    return true;
+  }
+  /**Append copies of data [start, position()) to have count copies*/
+  void repeat(int start, quint64 count) {
+    int size = position() - start;
+    for(quint64 i = 1; i < count; i++) {
+      memcpy(out, buffer.constData() + start, size);
+      out += size;
+    }
+  }
+  /**Append char in single byte codepage. Returns number of source chars used*/
+  int putEncoded(Codepage::Id codepage, const ushort *p, const ushort *e) {
+    if(QChar::isHighSurrogate(*p) && p + 1 < e && QChar::isLowSurrogate(p[1])) {
+      put(Codepage::UNMAPPED);
+      return 2;
+    }
+    put(Codepage::encode(codepage, *p));
+    return 1;
+  }
+  /**Append char in UTF-8. Returns number of source chars used, 0 if data is too large*/
+  int putUtf8(const ushort *p, const ushort *e) {
+    uint u = *p;
+    int used = 1;
+    if(QChar::isHighSurrogate(u) && p + 1 < e && QChar::isLowSurrogate(p[1])) {
+      u = QChar::surrogateToUcs4(static_cast<ushort>(u), p[1]);
+      used = 2;
+    } else if(QChar::isSurrogate(u)) {
+      u = QChar::ReplacementCharacter;
+    }
+    if(!reserve(4, e - p)) {
+      overflow = true;
+      return 0;
+    }
+    if(u < 0x800) {
+      put(static_cast<char>(0xC0 | (u >> 6)));
+    } else if(u < 0x10000) {
+      put(static_cast<char>(0xE0 | (u >> 12)));
+      put(static_cast<char>(0x80 | ((u >> 6) & 0x3F)));
+    } else {
+      put(static_cast<char>(0xF0 | (u >> 18)));
+      put(static_cast<char>(0x80 | ((u >> 12) & 0x3F)));
+      put(static_cast<char>(0x80 | ((u >> 6) & 0x3F)));
+    }
+    put(static_cast<char>(0x80 | (u & 0x3F)));
+    return used;
+  }
+};
+/*----------------------------------------------------------------------------*/
+/**
+ * Parse string literal body, p points after opening quote.
+ * Returns pointer after closing quote or nullptr if string is not terminated.
+ * Escape sequences: \n \t \r \a \b \f \v \e \" \' \\ \? \xHH and octal \ooo.
+ * \xHH and octal escapes give raw bytes, other chars are encoded in UTF-8 or codepage.
+ * lineStart receives output position after the last line feed of text in string.
+ * Data too large for output is reported by out.overflowed() and nullptr.
+ */
+static const ushort *parseString(const ushort *p, const ushort *end, ParserOutput& out, Codepage::Id codepage, int *lineStart = nullptr) {
+  while(p < end) {
+    ushort c = *p;
+    if(c == '"') {
+      return p + 1;
+    }
+    if(c >= 0x80) {
+      int used = codepage == Codepage::Utf8 ? out.putUtf8(p, end) : out.putEncoded(codepage, p, end);
+      if(!used) {
+        return nullptr;
+      }
+      p += used;
+      continue;
+    }
+    if(c != '\\') {
+      out.put(static_cast<char>(c));
+      p++;
+      if(c == '\n' && lineStart) {
+        *lineStart = out.position();
+      }
+      continue;
+    }
+    if(++p >= end) {
+      break;
+    }
+    c = *p++;
+    switch(c) {
+      case 'n': out.put('\n'); break;
+      case 't': out.put('\t'); break;
+      case 'r': out.put('\r'); break;
+      case 'a': out.put('\a'); break;
+      case 'b': out.put('\b'); break;
+      case 'f': out.put('\f'); break;
+      case 'v': out.put('\v'); break;
+      case 'e': out.put('\x1b'); break;
+      case '"':
+      case '\'':
+      case '\\':
+      case '?':
+        out.put(static_cast<char>(c));
+        break;
+      case 'x': {
+        int value = 0;
+        int digits = 0;
+        int d;
+        while(digits < 2 && p < end && (d = hexDigit(*p)) >= 0) {
+          value = value * 16 + d;
+          p++;
+          digits++;
+        }
+        if(digits) {
+          out.put(static_cast<char>(value));
+        } else {
+          //Not an escape: keep as is
+          out.put('\\');
+          out.put('x');
+        }
+        break;
+      }
+      default:
+        if(c >= '0' && c <= '7') {
+          int value = c - '0';
+          for(int digits = 1; digits < 3 && p < end && *p >= '0' && *p <= '7'; digits++) {
+            value = value * 8 + (*p++ - '0');
+          }
+          out.put(static_cast<char>(value));
+        } else {
+          //Unknown escape: keep backslash, char is handled by main loop
+          out.put('\\');
+          p--;
+        }
+        break;
+    }
+  }
+  return nullptr;
+}
+/*----------------------------------------------------------------------------*/
+static QString snippet(const ushort *p, const ushort *end) {
+  return QString(reinterpret_cast<const QChar *>(p), static_cast<int>(std::min<ptrdiff_t>(end - p, 10)));
+}
+/*----------------------------------------------------------------------------*/
+/**Decimal or 0x prefixed hex number. Returns pointer after number or nullptr*/
+static const ushort *parseNumber(const ushort *p, const ushort *end, quint64 *value) {
+  quint64 v = 0;
+  int base = 10;
+  if(p + 2 < end && p[0] == '0' && (p[1] | 0x20) == 'x' && hexDigit(p[2]) >= 0) {
+    base = 16;
+    p += 2;
+  }
+  const ushort *start = p;
+  int d;
+  while(p < end && (d = hexDigit(*p)) >= 0 && d < base) {
+    if(v > (~0ULL - d) / base) {
+      return nullptr;
+    }
+    v = v * base + d;
+    p++;
+  }
+  *value = v;
+  return p > start ? p : nullptr;
+}
+/*----------------------------------------------------------------------------*/
+static inline const ushort *skipBlanks(const ushort *p, const ushort *end) {
+  while(p < end && (*p == ' ' || *p == '\t')) {
+    p++;
+  }
+  return p;
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Typed number u8(V), u16le(V), u32be(A..B), u16be(A..B:STEP), p points after 'u'.
+ * Returns pointer after closing bracket or nullptr.
+ */
+static const ushort *parseTyped(const ushort *p, const ushort *end, ScriptNode *node) {
+  quint64 width = 0;
+  p = parseNumber(p, end, &width);
+  if(!p || (width != 8 && width != 16 && width != 32)) {
+    return nullptr;
+  }
+  node->type = ScriptNode::Counter;
+  node->size = static_cast<int>(width / 8);
+  node->bigEndian = false;
+  if(width > 8) {
+    if(p + 2 > end || (p[1] != 'e' || (p[0] != 'l' && p[0] != 'b'))) {
+      return nullptr;
+    }
+    node->bigEndian = p[0] == 'b';
+    p += 2;
+  }
+  if(p >= end || *p != '(') {
+    return nullptr;
+  }
+  quint64 max = width == 32 ? 0xffffffffULL : (1ULL << width) - 1;
+  quint64 first = 0, last = 0, step = 1;
+  p = parseNumber(skipBlanks(p + 1, end), end, &first);
+  if(!p) {
+    return nullptr;
+  }
+  last = first;
+  p = skipBlanks(p, end);
+  if(p + 1 < end && p[0] == '.' && p[1] == '.') {
+    p = parseNumber(skipBlanks(p + 2, end), end, &last);
+    if(!p) {
+      return nullptr;
+    }
+    p = skipBlanks(p, end);
+    if(p < end && *p == ':') {
+      p = parseNumber(skipBlanks(p + 1, end), end, &step);
+      if(!p || step == 0 || step > max) {
+        return nullptr;
+      }
+      p = skipBlanks(p, end);
+    }
+  }
+  if(p >= end || *p != ')' || first > max || last > max) {
+    return nullptr;
+  }
+  node->first = static_cast<quint32>(first);
+  node->last = static_cast<quint32>(last);
+  node->step = first <= last ? static_cast<qint64>(step) : -static_cast<qint64>(step);
+  return p + 1;
+}
+/*----------------------------------------------------------------------------*/
+/**Time with unit us, ms or s, ms by default. Returns pointer after it or nullptr*/
+static const ushort *parseTime(const ushort *p, const ushort *end, qint64 *ns) {
+  quint64 value = 0;
+  p = parseNumber(p, end, &value);
+  if(!p) {
+    return nullptr;
+  }
+  qint64 unit = 1000000;
+  if(p + 1 < end && p[0] == 'u' && p[1] == 's') {
+    unit = 1000;
+    p += 2;
+  } else if(p + 1 < end && p[0] == 'm' && p[1] == 's') {
+    p += 2;
+  } else if(p < end && p[0] == 's') {
+    unit = 1000000000;
+    p++;
+  }
+  if(value > static_cast<quint64>(LLONG_MAX / unit)) {
+    return nullptr;
+  }
+  *ns = static_cast<qint64>(value) * unit;
+  return p;
+}
+/*----------------------------------------------------------------------------*/
+static inline bool isName(const ushort *p, const ushort *end, const char *name) {
+  for(; *name; name++, p++) {
+    if(p >= end || *p != *name) {
+      return false;
+    }
+  }
+  return p >= end || !((*p >= 'a' && *p <= 'z') || *p == '-');
+}
+/*----------------------------------------------------------------------------*/
+/**Codepage name of @codepage directive. Returns pointer after name or nullptr*/
+static const ushort *parseCodepage(const ushort *p, const ushort *end, Codepage::Id *codepage) {
+  p = skipBlanks(p, end);
+  const ushort *start = p;
+  while(p < end && ((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') || (*p >= '0' && *p <= '9') || *p == '-')) {
+    p++;
+  }
+  if(p == start || !Codepage::fromName(QString(reinterpret_cast<const QChar *>(start), static_cast<int>(p - start)), codepage)) {
+    return nullptr;
+  }
+  return p;
+}
+/*----------------------------------------------------------------------------*/
+/**Checksum field {crc16:A..B}: bytes A..B of line data, B is the byte before field if omitted*/
+struct ChecksumField {
+  Crc::Kind kind = Crc::Crc16;
+  bool bigEndian = true;
+  qint64 first = 0;
+  qint64 last = -1;
+};
+/*----------------------------------------------------------------------------*/
+/**Parse checksum field, p points after '{'. Returns pointer after '}' or nullptr*/
+static const ushort *parseChecksum(const ushort *p, const ushort *end, ChecksumField *field) {
+  static const struct {
+    const char *name;
+    Crc::Kind kind;
+    bool bigEndian;
+  } names[] = {
+    {"crc16", Crc::Crc16, true},
+    {"crc32", Crc::Crc32, false},
+    {"xor", Crc::Xor8, false}
+  };
+  p = skipBlanks(p, end);
+  bool found = false;
+  for(const auto& name : names) {
+    const ushort *n = p;
+    const char *c = name.name;
+    while(*c && n < end && *n == *c) {
+      n++;
+      c++;
+    }
+    if(!*c) {
+      field->kind = name.kind;
+      field->bigEndian = name.bigEndian;
+      p = n;
+      found = true;
+      break;
+    }
+  }
+  if(!found) {
+    return nullptr;
+  }
+  if(field->kind != Crc::Xor8 && p + 1 < end && p[1] == 'e' && (p[0] == 'l' || p[0] == 'b')) {
+    field->bigEndian = p[0] == 'b';
+    p += 2;
+  }
+  p = skipBlanks(p, end);
+  if(p >= end || *p != ':') {
+    return nullptr;
+  }
+  quint64 first = 0, last = 0;
+  p = parseNumber(skipBlanks(p + 1, end), end, &first);
+  if(!p) {
+    return nullptr;
+  }
+  p = skipBlanks(p, end);
+  if(p + 1 >= end || p[0] != '.' || p[1] != '.') {
+    return nullptr;
+  }
+  p = skipBlanks(p + 2, end);
+  field->last = -1;
+  if(p < end && *p != '}') {
+    p = parseNumber(p, end, &last);
+    if(!p || last < first || last > INT_MAX) {
+      return nullptr;
+    }
+    field->last = static_cast<qint64>(last);
+    p = skipBlanks(p, end);
+  }
+  if(p >= end || *p != '}' || first > INT_MAX) {
+    return nullptr;
+  }
+  field->first = static_cast<qint64>(first);
+  return p + 1;
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Expand nodes of current line from lineNode. Line may start inside literal node:
+ * node merged with line bytes before line start, or run of previous line registered after it.
+ * pos receives negative offset of line start in the first chunk.
+ */
+static void expandLine(const CompiledScript *script, int lineStart, int lineNode, qint64 *pos,
+                       const std::function<bool(const QByteArray&)>& writer) {
+  int from = lineNode;
+  qint64 skip = 0;
+  auto literalBefore = [&](int i) {
+    const ScriptNode& node = script->nodes[i];
+    return node.type == ScriptNode::Bytes && node.repeat == 1 && node.offset < lineStart;
+  };
+  if(lineNode > 0 && literalBefore(lineNode - 1)
+     && script->nodes[lineNode - 1].offset + script->nodes[lineNode - 1].size > lineStart) {
+    from = lineNode - 1;
+  } else if(lineNode < script->nodes.size() && literalBefore(lineNode)
+            && script->nodes[lineNode].offset + script->nodes[lineNode].size <= lineStart) {
+    from = lineNode + 1;
+  }
+  if(from < script->nodes.size() && literalBefore(from)) {
+    skip = lineStart - script->nodes[from].offset;
+  }
+  *pos = -skip;
+  script->expand(writer, CompiledScript::EXPAND_CHUNK, from);
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Checksum over data of current line: literals from lineStart or, if line has generators,
+ * expanded nodes from lineNode (literal bytes must be registered). Returns false if range
+ * is out of line data.
+ * Both sources are fed by chunks to the same range check, so expanded and compiled
+ * scripts give the same value or fail the same way.
+ */
+static bool lineChecksum(const QByteArray& literals, const CompiledScript *script, int lineStart, int lineNode,
+                         int position, ChecksumField field, quint32 *value) {
+  quint32 state = Crc::init(field.kind);
+  qint64 pos = 0; //Line offset of chunk
+  auto feed = [&](const char *chunk, qint64 size) {
+    qint64 begin = std::max<qint64>(pos, field.first);
+    qint64 end = field.last < 0 ? pos + size : std::min<qint64>(pos + size, field.last + 1);
+    if(begin < end) {
+      state = Crc::update(field.kind, chunk + (begin - pos), end - begin, state);
+    }
+    pos += size;
+    return field.last < 0 || pos <= field.last;
+  };
+  if(!script || script->nodes.size() == lineNode) {
+    //Line data is literal bytes only
+    feed(literals.constData() + lineStart, position - lineStart);
+  } else {
+    expandLine(script, lineStart, lineNode, &pos, [&](const QByteArray& chunk) {
+      return feed(chunk.constData(), chunk.size());
+    });
+  }
+  if(field.last < 0) {
+    field.last = pos - 1;
+  }
+  if(field.last >= pos || field.first > field.last) {
+    return false;
+  }
+  *value = state;
+  return true;
+}
+/*----------------------------------------------------------------------------*/
+static inline void encodeValue(char *out, quint32 value, int size, bool bigEndian) {
+  for(int i = 0; i < size; i++) {
+    out[bigEndian ? size - 1 - i : i] = static_cast<char>(value >> (i * 8));
+  }
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Lexer. Generators are expanded to buffer if script is nullptr,
+ * or registered as nodes of script (buffer is script literals).
+ * Codepage of strings is taken from and returned to codepage, UTF-8 if it is nullptr.
+ * errorPosition receives offset of syntax error from begin, or -1.
+ */
+static ParserState lexFragment(const ushort *begin, const ushort *end, ParserState state, QByteArray& buffer, CompiledScript *script,
+                               int *stringStart, Codepage::Id *codepage, int *errorPosition) {
+  const ushort *p = begin;
+  ParserOutput out(buffer, static_cast<int>(end - begin));
+  Codepage::Id cp = codepage ? *codepage : Codepage::Utf8;
 
-  // Regex definition using five capturing groups (excluding Group 0 - full match):
-  // Group 1 & 2: String literal ("...") - Must be first for priority.
-  // Group 3: Comment (#.*)
-  // Group 4: Hex Byte (1 or 2 chars, e.g., 50, f, AA).
-  // Group 5: Delimiters (whitespace, comma).
-  QRegularExpression tokenRegex(
-        "(\"([^\"\\\\]*(?:\\\\.[^\"\\\\]*)*)\")"   // Group 1 (full string) & Group 2 (content)
-        "|(#.*)"                                  // Group 3 (COMMENT)
-        "|([0-9a-fA-F]{1,2})"                     // Group 4 (HEX_BYTE)
-        "|([\\s,]+)"                              // Group 5 (DELIMITER)
-        );
-
-  int offset = 0;
-  while (offset < inputText.length()) {
-    QRegularExpressionMatch match = tokenRegex.match(inputText, offset);
-
-    if (match.hasMatch() && match.capturedStart() == offset) {
-      offset = match.capturedEnd();
+  //Last token for repeat: literal bytes [itemStart, itemEnd) or node
+  enum {NoItem, LiteralItem, NodeItem, ContinuedItem} item = NoItem;
+  int itemStart = 0;
+  int itemEnd = 0;
+  int runStart = out.position(); //Literal bytes not registered in script yet
+  //Checksum offsets count from output of the current text line
+  int lineStart = out.position();
+  int lineNode = script ? script->nodes.size() : 0;
+  const char *error = nullptr;
 
-      // Handle String literal (We check if Group 1, the full token, is not empty)
-      if (!match.captured(1).isEmpty()) {
-        // Use the enum for the content group index
-        QString content = match.captured(Group::STRING_CONTENT);
+  auto flushRun = [&](int upto) {
+    if(script) {
+      script->appendBytes(runStart, upto - runStart);
+      runStart = upto;
+    }
+  };
+  auto finish = [&](ParserState result) {
+    if(error) {
+      qWarning() << "Syntax error at position" << (p - begin) << "." << error << snippet(p, end) << "...";
+      if(errorPosition) {
+        *errorPosition = static_cast<int>(p - begin);
+      }
+    }
+    flushRun(out.position());
+    if(codepage) {
+      *codepage = cp;
+    }
+    return result;
+  };
 
-        // Simple C-style escape sequences unescaping.
-        QString unescapedContent = content;
-        unescapedContent.replace("\\n", "\n");
-        unescapedContent.replace("\\t", "\t");
-        unescapedContent.replace("\\r", "\r");
-        unescapedContent.replace("\\a", "\a");
-        unescapedContent.replace("\\b", "\b");
-        unescapedContent.replace("\\f", "\f");
-        unescapedContent.replace("\\0", "\0");
-        unescapedContent.replace("\\\"", "\"");
-        unescapedContent.replace("\\\'", "\'");
-        unescapedContent.replace("\\\\", "\\");
+  if(stringStart) {
+    *stringStart = -1;
+  }
+  if(errorPosition) {
+    *errorPosition = -1;
+  }
+  if(state == ParserInString) {
+    p = parseString(p, end, out, cp, &lineStart);
+    if(!p) {
+      if(out.overflowed()) {
+        error = "Data too large";
+        return finish(ParserError);
+      }
+      return finish(ParserInString);
+    }
+    item = ContinuedItem;
+  }
 
-        // Append unescaped string as UTF-8 bytes
-        result.append(unescapedContent.toUtf8());
+  while(p < end) {
+    ushort c = *p;
+    int d = hexDigit(c);
+    if(d >= 0) {
+      int d2 = p + 1 < end ? hexDigit(p[1]) : -1;
+      if(d2 >= 0) {
+        d = d * 16 + d2;
+        p += 2;
+      } else {
+        p++;
+      }
+      //Byte range: 00..FF
+      if(p + 2 < end && p[0] == '.' && p[1] == '.' && hexDigit(p[2]) >= 0) {
+        int last = hexDigit(p[2]);
+        p += 3;
+        if(p < end && hexDigit(*p) >= 0) {
+          last = last * 16 + hexDigit(*p++);
+        }
+        ScriptNode node;
+        node.type = ScriptNode::Counter;
+        node.size = 1;
+        node.first = d;
+        node.last = last;
+        node.step = d <= last ? 1 : -1;
+        if(script) {
+          flushRun(out.position());
+          node.offset = out.position();
+          script->nodes.append(node);
+          item = NodeItem;
+        } else {
+          itemStart = out.position();
+          if(!out.reserve(node.passSize(), end - p)) {
+            error = "Data too large";
+            return finish(ParserError);
+          }
+          for(qint64 v = d; ; v += node.step) {
+            out.put(static_cast<char>(v));
+            if(v == last) {
+              break;
+            }
+          }
+          itemEnd = out.position();
+          item = LiteralItem;
+        }
+        continue;
+      }
+      itemStart = out.position();
+      out.put(static_cast<char>(d));
+      itemEnd = out.position();
+      item = LiteralItem;
+    } else if(isDelimiter(c)) {
+      if(c == '\n') {
+        item = NoItem;
+        lineStart = out.position();
+        lineNode = script ? script->nodes.size() : 0;
+      }
+      p++;
+    } else if(c == '"') {
+      if(stringStart) {
+        *stringStart = out.written();
+      }
+      itemStart = out.position();
+      int stringLine = lineStart;
+      p = parseString(p + 1, end, out, cp, &lineStart);
+      if(lineStart != stringLine) {
+        lineNode = script ? script->nodes.size() : 0;
+      }
+      if(!p) {
+        if(out.overflowed()) {
+          error = "Data too large";
+          return finish(ParserError);
+        }
+        return finish(ParserInString);
+      }
+      if(stringStart) {
+        *stringStart = -1;
+      }
+      itemEnd = out.position();
+      //Copies of line feed would start lines inside repeat: checksum line is not defined
+      item = lineStart != stringLine ? ContinuedItem : LiteralItem;
+    } else if(c == 'u') {
+      ScriptNode node;
+      const ushort *next = parseTyped(p + 1, end, &node);
+      if(!next) {
+        error = "Bad number, expected u8(V), u16le(V), u32be(A..B:STEP)";
+        return finish(ParserError);
+      }
+      p = next;
+      if(node.first == node.last) {
+        //Single value is literal
+        itemStart = out.position();
+        out.putValue(node.first, node.size, node.bigEndian);
+        itemEnd = out.position();
+        item = LiteralItem;
+      } else if(script) {
+        flushRun(out.position());
+        node.offset = out.position();
+        script->nodes.append(node);
+        item = NodeItem;
+      } else {
+        itemStart = out.position();
+        quint64 size = node.passSize();
+        if(!out.reserve(size, end - p)) {
+          error = "Data too large";
+          return finish(ParserError);
+        }
+        for(qint64 v = node.first; ; v += node.step) {
+          out.putValue(static_cast<quint32>(v), node.size, node.bigEndian);
+          if(node.step > 0 ? v + node.step > node.last : v + node.step < node.last) {
+            break;
+          }
+        }
+        itemEnd = out.position();
+        item = LiteralItem;
+      }
+    } else if(c == '*') {
+      quint64 count = 0;
+      const ushort *next = parseNumber(skipBlanks(p + 1, end), end, &count);
+      if(!next) {
+        error = "Repeat count expected";
+        return finish(ParserError);
+      }
+      if(item == NoItem || item == ContinuedItem) {
+        error = item == NoItem ? "Nothing to repeat" : "Multiline string can not be repeated";
+        return finish(ParserError);
+      }
+      p = next;
+      if(item != NodeItem && itemEnd == itemStart) {
+        //Empty string repeated is empty: no node of zero size
+      } else if(item == NodeItem) {
+        ScriptNode& node = script->nodes.last();
+        quint64 total = node.passSize() * node.repeat;
+        if(count && total > ~0ULL / count) {
+          error = "Repeat count too large";
+          return finish(ParserError);
+        }
+        node.repeat *= count;
+      } else if(script) {
+        flushRun(itemStart);
+        ScriptNode node;
+        node.offset = itemStart;
+        node.size = itemEnd - itemStart;
+        node.repeat = count;
+        script->nodes.append(node);
+        runStart = itemEnd;
+        item = NodeItem;
+      } else {
+        quint64 size = itemEnd - itemStart;
+        if(count && size > ParserOutput::MAX_SIZE / count) {
+          error = "Data too large";
+          return finish(ParserError);
+        }
+        if(count == 0) {
+          out.rewind(itemStart);
+        } else if(!out.reserve(size * (count - 1), end - p)) {
+          error = "Data too large";
+          return finish(ParserError);
+        }
+        out.repeat(itemStart, count);
+        itemEnd = out.position();
+      }
+    } else if(c == '@') {
+      //Directives: @delay TIME, @flush, @wait-for "BYTES" [TIMEOUT], @codepage NAME
+      ScriptNode node;
+      int patternStart = out.position();
+      p++;
+      if(isName(p, end, "codepage")) {
+        //Compile time only: strings after it are encoded in codepage
+        const ushort *next = parseCodepage(p + 8, end, &cp);
+        if(!next) {
+          error = "Codepage expected: utf8, cp437, cp866, cp1251";
+          return finish(ParserError);
+        }
+        p = next;
+        item = NoItem;
+        continue;
+      }
+      if(isName(p, end, "delay")) {
+        node.type = ScriptNode::Delay;
+        const ushort *next = parseTime(skipBlanks(p + 5, end), end, &node.time);
+        if(!next) {
+          error = "Delay time expected";
+          return finish(ParserError);
+        }
+        p = next;
+      } else if(isName(p, end, "flush")) {
+        node.type = ScriptNode::Flush;
+        p += 5;
+      } else if(isName(p, end, "wait-for")) {
+        node.type = ScriptNode::WaitFor;
+        node.time = 1000000000LL;
+        p = skipBlanks(p + 8, end);
+        const ushort *next = p < end && *p == '"' ? parseString(p + 1, end, out, cp) : nullptr;
+        if(!next || out.position() == patternStart) {
+          out.rewind(patternStart);
+          error = out.overflowed() ? "Data too large" : "Expected bytes to wait for in quotes";
+          return finish(ParserError);
+        }
+        p = skipBlanks(next, end);
+        if(p < end && *p >= '0' && *p <= '9') {
+          p = parseTime(p, end, &node.time);
+          if(!p) {
+            p = next;
+            out.rewind(patternStart);
+            error = "Bad timeout";
+            return finish(ParserError);
+          }
+        }
+        node.offset = patternStart;
+        node.size = out.position() - patternStart;
+      } else {
+        error = "Unknown directive:";
+        return finish(ParserError);
+      }
+      if(script) {
+        //Pattern is kept in literals but it is not data
+        flushRun(patternStart);
+        if(node.type != ScriptNode::WaitFor) {
+          node.offset = patternStart;
+        }
+        script->nodes.append(node);
+        runStart = out.position();
+      } else {
+        out.rewind(patternStart);
+      }
+      item = NoItem;
+    } else if(c == '{') {
+      ChecksumField field;
+      const ushort *next = parseChecksum(p + 1, end, &field);
+      if(!next) {
+        error = "Bad checksum, expected {crc16:A..B}, {crc32le:A..}, {xor:A..B}";
+        return finish(ParserError);
+      }
+      if(script && script->nodes.size() != lineNode) {
+        flushRun(out.position());
+      }
+      quint32 value = 0;
+      if(!lineChecksum(buffer, script, lineStart, lineNode, out.position(), field, &value)) {
+        error = "Checksum range is out of line data before it:";
+        return finish(ParserError);
+      }
+      p = next;
+      itemStart = out.position();
+      out.putValue(value, Crc::size(field.kind), field.bigEndian);
+      itemEnd = out.position();
+      item = LiteralItem;
+    } else if(c == '#') {
+      while(p < end && *p != '\n') {
+        p++;
+      }
+      item = NoItem;
+    } else {
+      error = "Unexpected text:";
+      return finish(ParserError);
+    }
+  }
+  return finish(ParserNormal);
+}
+/*----------------------------------------------------------------------------*/
+static inline ParserState lexRange(const ushort *begin, const ushort *end, ParserState state, QByteArray *result,
+                                  int *stringStart, Codepage::Id *codepage, int *errorPosition) {
+  return lexFragment(begin, end, state, *result, nullptr, stringStart, codepage, errorPosition);
+}
+/*----------------------------------------------------------------------------*/
+static inline ParserState lexRange(const ushort *begin, const ushort *end, ParserState state, CompiledScript *result,
+                                  int *stringStart, Codepage::Id *codepage, int *errorPosition) {
+  return lexFragment(begin, end, state, result->literals, result, stringStart, codepage, errorPosition);
+}
+/*----------------------------------------------------------------------------*/
+static inline const ushort *textBegin(const QString& text) {
+  return reinterpret_cast<const ushort *>(text.constData());
+}
+/*----------------------------------------------------------------------------*/
+ParserState parseFragment(const QString& text, ParserState state, QByteArray *result, int *stringStart, Codepage::Id *codepage,
+                          int *errorPosition) {
+  return lexRange(textBegin(text), textBegin(text) + text.size(), state, result, stringStart, codepage, errorPosition);
+}
+/*----------------------------------------------------------------------------*/
+ParserState parseFragment(const QString& text, ParserState state, CompiledScript *result, int *stringStart, Codepage::Id *codepage,
+                          int *errorPosition) {
+  return lexRange(textBegin(text), textBegin(text) + text.size(), state, result, stringStart, codepage, errorPosition);
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Pre-scan: string state at the end of text part starting at line start.
+ * Only quotes, escapes, comments and @codepage matter, syntax errors are not detected.
+ * codepage receives the last @codepage of part, it is not changed if there is none.
+ */
+static ParserState scanStrings(const ushort *p, const ushort *end, ParserState state, int *codepage) {
+  bool inString = state == ParserInString;
+  while(p < end) {
+    ushort c = *p++;
+    if(inString) {
+      if(c == '\\') {
+        p++;
+      } else if(c == '"') {
+        inString = false;
+      }
+    } else if(c == '"') {
+      inString = true;
+    } else if(c == '#') {
+      while(p < end && *p != '\n') {
+        p++;
+      }
+    } else if(c == '@' && isName(p, end, "codepage")) {
+      Codepage::Id id;
+      const ushort *next = parseCodepage(p + 8, end, &id);
+      if(next) {
+        *codepage = id;
+        p = next;
+      }
+    }
+  }
+  return inString ? ParserInString : ParserNormal;
+}
+/*----------------------------------------------------------------------------*/
+/**Run job(0) ... job(count - 1) on up to threads threads, calling thread included*/
+static void runParallel(int count, int threads, const std::function<void(int)>& job) {
+  std::atomic<int> next {0};
+  auto worker = [&]() {
+    for(int i; (i = next++) < count;) {
+      job(i);
+    }
+  };
+  std::vector<std::thread> pool;
+  for(int i = 1; i < std::min(threads, count); i++) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for(auto& thread : pool) {
+    thread.join();
+  }
+}
+/*----------------------------------------------------------------------------*/
+static inline QByteArray& outputBytes(QByteArray& output) {
+  return output;
+}
+/*----------------------------------------------------------------------------*/
+static inline QByteArray& outputBytes(CompiledScript& output) {
+  return output.literals;
+}
+/*----------------------------------------------------------------------------*/
+template<class Output>
+static ParserState parseSegments(const QString& text, ParserState state, Output *result, int *stringStart, Codepage::Id *codepage, int threads,
+                                 int *errorPosition) {
+  enum {
+    PARALLEL_MIN = 1024 * 1024, //Chars, smaller text is parsed by calling thread
+    SEGMENTS_PER_THREAD = 4     //For load balance
+  };
+  if(threads <= 0) {
+    threads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  if(errorPosition) {
+    *errorPosition = -1;
+  }
+  const ushort *begin = textBegin(text);
+  int size = text.size();
+  if(threads <= 1 || size < PARALLEL_MIN) {
+    return lexRange(begin, begin + size, state, result, stringStart, codepage, errorPosition);
+  }
 
-        // Handle Comment (Group 3)
-      } else if (!match.captured(Group::COMMENT).isEmpty()) {
-        // Ignore the comment, offset is already advanced.
+  //Segments start at line starts, so lexer state there is Normal or InString
+  std::vector<int> bounds {0};
+  int count = threads * SEGMENTS_PER_THREAD;
+  for(int i = 1; i < count; i++) {
+    int pos = std::max(static_cast<int>(static_cast<qint64>(size) * i / count), bounds.back());
+    int nl = text.indexOf(QChar('\n'), pos);
+    if(nl < 0 || nl + 1 >= size) {
+      break;
+    }
+    if(nl + 1 > bounds.back()) {
+      bounds.push_back(nl + 1);
+    }
+  }
+  bounds.push_back(size);
+  count = static_cast<int>(bounds.size()) - 1;
 
-        // Handle Hexadecimal byte (Group 4)
-      } else if (!match.captured(Group::HEX_BYTE).isEmpty()) {
-        QString hexByte = match.captured(Group::HEX_BYTE);
-        bool ok;
-        // Convert 1 or 2-char hex string to an 8-bit unsigned integer (byte)
-        char byteValue = hexByte.toUShort(&ok, 16);
+  //Pre-scan every segment from both states, then chain states in order
+  std::vector<ParserState> endNormal(count), endInString(count);
+  std::vector<int> codepageNormal(count, -1), codepageInString(count, -1);
+  runParallel(count, threads, [&](int i) {
+    endNormal[i] = scanStrings(begin + bounds[i], begin + bounds[i + 1], ParserNormal, &codepageNormal[i]);
+    endInString[i] = scanStrings(begin + bounds[i], begin + bounds[i + 1], ParserInString, &codepageInString[i]);
+  });
+  std::vector<ParserState> starts(count);
+  std::vector<Codepage::Id> startCodepages(count);
+  starts[0] = state == ParserInString ? ParserInString : ParserNormal;
+  startCodepages[0] = codepage ? *codepage : Codepage::Utf8;
+  for(int i = 1; i < count; i++) {
+    bool inString = starts[i - 1] == ParserInString;
+    starts[i] = inString ? endInString[i - 1] : endNormal[i - 1];
+    int changed = inString ? codepageInString[i - 1] : codepageNormal[i - 1];
+    startCodepages[i] = changed >= 0 ? static_cast<Codepage::Id>(changed) : startCodepages[i - 1];
+  }
 
-        if (ok) {
-          result.append(byteValue);
-        } else {
-          qWarning() << "Parsing error for hex byte:" << hexByte;
-        }
+  std::vector<Output> parts(count);
+  std::vector<ParserState> states(count);
+  std::vector<int> opens(count);
+  std::vector<int> errors(count, -1);
+  std::vector<Codepage::Id> codepages(startCodepages);
+  runParallel(count, threads, [&](int i) {
+    states[i] = lexRange(begin + bounds[i], begin + bounds[i + 1], starts[i], &parts[i], &opens[i], &codepages[i], &errors[i]);
+  });
 
-        // Handle Delimiters (Group 5)
-      } else if (!match.captured(Group::DELIMITER).isEmpty()) {
-        // Ignore delimiters, just advance the offset
+  //Join in order
+  QByteArray& bytes = outputBytes(*result);
+  int base = bytes.size();
+  qint64 total = base;
+  for(auto& part : parts) {
+    total += outputBytes(part).size();
+  }
+  if(total <= INT_MAX) {
+    bytes.reserve(static_cast<int>(total));
+  }
+  ParserState current = starts[0];
+  Codepage::Id currentCodepage = startCodepages[0];
+  int open = -1;
+  for(int i = 0; i < count; i++) {
+    if(current != starts[i] || currentCodepage != startCodepages[i]) {
+      //Pre-scan did not match lexer: parse segment again in real state
+      parts[i] = Output();
+      codepages[i] = currentCodepage;
+      states[i] = lexRange(begin + bounds[i], begin + bounds[i + 1], current, &parts[i], &opens[i], &codepages[i], &errors[i]);
+    }
+    if(states[i] == ParserInString && opens[i] >= 0) {
+      open = bytes.size() - base + opens[i];
+    } else if(states[i] != ParserInString) {
+      open = -1;
+    }
+    result->append(parts[i]);
+    parts[i] = Output();
+    current = states[i];
+    currentCodepage = codepages[i];
+    if(current == ParserError) {
+      if(errorPosition) {
+        *errorPosition = bounds[i] + errors[i];
       }
+      break;
+    }
+  }
+  if(stringStart) {
+    *stringStart = current == ParserInString ? open : -1;
+  }
+  if(codepage) {
+    *codepage = currentCodepage;
+  }
+  return current;
+}
+/*----------------------------------------------------------------------------*/
+ParserState parseParallel(const QString& text, ParserState state, QByteArray *result, int *stringStart,
+                          Codepage::Id *codepage, int threads, int *errorPosition) {
+  return parseSegments(text, state, result, stringStart, codepage, threads, errorPosition);
+}
+/*----------------------------------------------------------------------------*/
+ParserState parseParallel(const QString& text, ParserState state, CompiledScript *result, int *stringStart,
+                          Codepage::Id *codepage, int threads, int *errorPosition) {
+  return parseSegments(text, state, result, stringStart, codepage, threads, errorPosition);
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * @brief Parses a text block containing strings, hex bytes, delimiters, and comments.
+ * Single pass lexer: hex bytes are 1 or 2 hex digits, strings are in double quotes
+ * and may span lines, comments (#) run to the end of line, delimiters are
+ * blank characters and commas. Generators: byte range 00..FF, typed numbers
+ * u8(V), u16le(V), u32be(V) and counters u16le(A..B:STEP), repeat of previous
+ * item ITEM*COUNT. Checksum fields {crc16:A..B}, {crc32le:A..}, {xor:A..B} over
+ * bytes A..B of the current line. Strings are encoded in codepage, @codepage NAME
+ * changes it. Directives @delay, @flush and @wait-for give no data here.
+ * @param text The input text block (QString).
+ * @param codepage Codepage of strings until the first @codepage.
+ * @return QByteArray containing the parsed data (bytes from strings and hex values).
+ */
+QByteArray parseText(const QString& text, Codepage::Id codepage) {
+  QByteArray result;
+  int stringStart = -1;
+  if(parseParallel(text, ParserNormal, &result, &stringStart, &codepage) == ParserInString) {
+    qWarning() << "Syntax error: unterminated string";
+    result.resize(stringStart);
+  }
+  return result;
+}
+/*----------------------------------------------------------------------------*/
+quint64 ScriptNode::passSize() const {
+  if(type == Bytes) {
+    return size;
+  }
+  if(isCommand()) {
+    return 0;
+  }
+  quint64 range = first <= last ? last - first : first - last;
+  return (range / static_cast<quint64>(step < 0 ? -step : step) + 1) * size;
+}
+/*----------------------------------------------------------------------------*/
+quint64 CompiledScript::size() const {
+  quint64 result = 0;
+  for(const auto& node : nodes) {
+    result += node.passSize() * node.repeat;
+  }
+  return result;
+}
+/*----------------------------------------------------------------------------*/
+bool CompiledScript::hasCommands() const {
+  for(const auto& node : nodes) {
+    if(node.isCommand()) {
+      return true;
+    }
+  }
+  return false;
+}
+/*----------------------------------------------------------------------------*/
+void CompiledScript::appendBytes(int offset, int size) {
+  if(size <= 0) {
+    return;
+  }
+  if(!nodes.isEmpty()) {
+    ScriptNode& node = nodes.last();
+    if(node.type == ScriptNode::Bytes && node.repeat == 1 && node.offset + node.size == offset) {
+      node.size += size;
+      return;
+    }
+  }
+  ScriptNode node;
+  node.offset = offset;
+  node.size = size;
+  nodes.append(node);
+}
+/*----------------------------------------------------------------------------*/
+void CompiledScript::append(const CompiledScript& script) {
+  int base = literals.size();
+  literals.append(script.literals);
+  for(ScriptNode node : script.nodes) {
+    node.offset += base;
+    if(node.type == ScriptNode::Bytes && node.repeat == 1) {
+      appendBytes(node.offset, node.size);
     } else {
-      // Unexpected character or unrecognised token at current position
-      QString errorSnippet = inputText.mid(offset, 10);
-      qWarning() << "Syntax error at position" << offset << ". Unexpected text:" << errorSnippet << "...";
+      nodes.append(node);
+    }
+  }
+}
+/*----------------------------------------------------------------------------*/
+CompiledScript CompiledScript::splitTail(int offset) {
+  CompiledScript tail;
+  tail.literals = literals.mid(offset);
+  tail.appendBytes(0, tail.literals.size());
+  while(!nodes.isEmpty()) {
+    ScriptNode& node = nodes.last();
+    if(node.type != ScriptNode::Bytes || node.repeat != 1 || node.offset + node.size <= offset) {
+      break;
+    }
+    if(node.offset < offset) {
+      node.size = offset - node.offset;
       break;
     }
+    nodes.removeLast();
   }
-
+  literals.resize(offset);
+  return tail;
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Output of expand(): fills chunks and passes them to writer.
+ */
+class ExpandOutput {
+  const std::function<bool(const QByteArray&)>& writer;
+  int chunkSize;
+  QByteArray chunk;
+  char *out = nullptr;
+  char *end = nullptr;
+public:
+  ExpandOutput(const std::function<bool(const QByteArray&)>& w, int size) : writer(w), chunkSize(size) {
+  }
+  bool flush() {
+    if(!out) {
+      return true;
+    }
+    chunk.resize(static_cast<int>(out - chunk.constData()));
+    out = end = nullptr;
+    //Writer may keep chunk: next one is new array
+    return chunk.isEmpty() || writer(chunk);
+  }
+  inline bool room() {
+    if(out != end) {
+      return true;
+    }
+    if(!flush()) {
+      return false;
+    }
+    chunk = QByteArray(chunkSize, Qt::Uninitialized);
+    out = chunk.data();
+    end = out + chunkSize;
+    return true;
+  }
+  bool write(const char *data, quint64 size) {
+    while(size) {
+      if(!room()) {
+        return false;
+      }
+      size_t n = static_cast<size_t>(std::min<quint64>(size, end - out));
+      memcpy(out, data, n);
+      out += n;
+      data += n;
+      size -= n;
+    }
+    return true;
+  }
+  bool fill(char c, quint64 size) {
+    while(size) {
+      if(!room()) {
+        return false;
+      }
+      size_t n = static_cast<size_t>(std::min<quint64>(size, end - out));
+      memset(out, c, n);
+      out += n;
+      size -= n;
+    }
+    return true;
+  }
+};
+/*----------------------------------------------------------------------------*/
+bool CompiledScript::expand(const std::function<bool(const QByteArray&)>& writer, int chunkSize, int from, int to) const {
+  enum {
+    TILE_SIZE = 4096 //Short patterns are copied by tiles
+  };
+  ExpandOutput out(writer, chunkSize);
+  if(to < 0) {
+    to = nodes.size();
+  }
+  for(int i = from; i < to; i++) {
+    const ScriptNode& node = nodes[i];
+    if(node.isCommand()) {
+      continue;
+    }
+    if(node.type == ScriptNode::Bytes) {
+      const char *data = literals.constData() + node.offset;
+      if(node.size == 1) {
+        if(!out.fill(*data, node.repeat)) {
+          return false;
+        }
+        continue;
+      }
+      quint64 repeat = node.repeat;
+      QByteArray tile;
+      if(node.size < TILE_SIZE / 2 && repeat > 2) {
+        int copies = static_cast<int>(std::min<quint64>(TILE_SIZE / node.size, repeat));
+        for(int i = 0; i < copies; i++) {
+          tile.append(data, node.size);
+        }
+        for(; repeat >= static_cast<quint64>(copies); repeat -= copies) {
+          if(!out.write(tile.constData(), tile.size())) {
+            return false;
+          }
+        }
+      }
+      for(; repeat; repeat--) {
+        if(!out.write(data, node.size)) {
+          return false;
+        }
+      }
+      continue;
+    }
+    char value[4];
+    for(quint64 r = 0; r < node.repeat; r++) {
+      for(qint64 v = node.first; ; v += node.step) {
+        encodeValue(value, static_cast<quint32>(v), node.size, node.bigEndian);
+        if(!out.write(value, node.size)) {
+          return false;
+        }
+        if(node.step > 0 ? v + node.step > node.last : v + node.step < node.last) {
+          break;
+        }
+      }
+    }
+  }
+  return out.flush();
+}
+/*----------------------------------------------------------------------------*/
+QByteArray CompiledScript::toByteArray(int limit) const {
+  QByteArray result;
+  expand([&](const QByteArray& chunk) {
+    result.append(chunk.constData(), std::min(chunk.size(), limit - result.size()));
+    return result.size() < limit;
+  });
   return result;
 }
+/*----------------------------------------------------------------------------*/
@@ -16,8 +16,104 @@
 #define TEXT_PARSER_H_1761552064
 /*----------------------------------------------------------------------------*/
 #include <QByteArray>
-QByteArray parseText(const QString& text);
-void parseTest();
+#include <QString>
+#include <QVector>
+#include <functional>
+#include <memory>
+#include <climits>
+#include "codepage.h"
+QByteArray parseText(const QString& text, Codepage::Id codepage = Codepage::Utf8);
+
+/**
+ * Node of compiled script. Repeats and counters are kept as generators
+ * and expanded only when data is written.
+ */
+struct ScriptNode {
+  enum Type {
+    Bytes,   //Literal bytes [offset, offset + size) repeated `repeat` times
+    Counter, //Values first, first + step, ... last, `size` bytes each
+    //Commands, executed by sender between data
+    Delay,   //Wait until data is accepted by device, then pause for `time`
+    Flush,   //Wait until data is accepted by device
+    WaitFor  //Wait up to `time` for received bytes [offset, offset + size)
+  };
+  Type type = Bytes;
+  int offset = 0;         //Offset in CompiledScript::literals. For Counter: position where it was inserted
+  int size = 0;
+  quint64 repeat = 1;
+  quint32 first = 0;
+  quint32 last = 0;
+  qint64 step = 1;        //Negative for descending counter
+  bool bigEndian = false;
+  qint64 time = 0;        //Delay or wait timeout, nanoseconds
+
+  bool isCommand() const {return type >= Delay;}
+  /**Bytes of one pass*/
+  quint64 passSize() const;
+};
+
+/**
+ * Script compiled to literal bytes and generator nodes.
+ */
+class CompiledScript {
+public:
+  enum {
+    EXPAND_CHUNK = 64 * 1024
+  };
+  QByteArray literals;
+  QVector<ScriptNode> nodes;
+  std::shared_ptr<const void> storage; //Keeps literals mapped from cache file
+
+  bool isEmpty() const {return nodes.isEmpty();}
+  bool hasCommands() const;
+  /**Size of expanded data*/
+  quint64 size() const;
+  /**Register literal bytes appended to literals, merged with previous node when possible*/
+  void appendBytes(int offset, int size);
+  void append(const CompiledScript& script);
+  /**Remove and return literal bytes from offset. Offset must be in the last node*/
+  CompiledScript splitTail(int offset);
+  /**
+   * Expand data of nodes [from, to) by chunks of up to chunkSize bytes, commands are skipped.
+   * Writer gets every chunk, returns false to stop. Returns false if stopped.
+   */
+  bool expand(const std::function<bool(const QByteArray&)>& writer, int chunkSize = EXPAND_CHUNK, int from = 0, int to = -1) const;
+  /**Expanded data up to limit bytes*/
+  QByteArray toByteArray(int limit = INT_MAX) const;
+};
+
+/**Lexer state at the end of text fragment*/
+enum ParserState {
+  ParserNormal,
+  ParserInString, //Fragment ends inside string literal
+  ParserError     //Syntax error, rest of fragment is ignored
+};
+/**
+ * Parse fragment of text starting in given state and append bytes to result.
+ * Fragments must be split at line ends (line feed included into fragment).
+ * stringStart receives result offset of string opened and not closed in this fragment, or -1.
+ * codepage of strings is carried like state: codepage at fragment start, set to codepage at end.
+ * UTF-8 is used if it is nullptr.
+ * errorPosition receives index in text of syntax error, or -1.
+ * Repeats and counters are expanded, directives are ignored.
+ */
+ParserState parseFragment(const QString& text, ParserState state, QByteArray *result, int *stringStart = nullptr,
+                          Codepage::Id *codepage = nullptr, int *errorPosition = nullptr);
+/**
+ * Same as above, repeats and counters are kept as generator nodes,
+ * directives are compiled to command nodes.
+ * stringStart is relative to result literals size before call.
+ */
+ParserState parseFragment(const QString& text, ParserState state, CompiledScript *result, int *stringStart = nullptr,
+                          Codepage::Id *codepage = nullptr, int *errorPosition = nullptr);
+/**
+ * Same as parseFragment(), big text is split at line starts and parsed by up to threads threads
+ * (0: one per core). String state and codepage at segment starts are found by quick pre-scan.
+ */
+ParserState parseParallel(const QString& text, ParserState state, QByteArray *result, int *stringStart = nullptr,
+                          Codepage::Id *codepage = nullptr, int threads = 0, int *errorPosition = nullptr);
+ParserState parseParallel(const QString& text, ParserState state, CompiledScript *result, int *stringStart = nullptr,
+                          Codepage::Id *codepage = nullptr, int threads = 0, int *errorPosition = nullptr);
 /*----------------------------------------------------------------------------*/
 #endif /*TEXT_PARSER_H_1761552064*/
 
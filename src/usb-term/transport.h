@@ -0,0 +1,164 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg transport
+*/
+/**
+* Abstract data transport: USB connection, virtual device etc.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 11:40:05<br>
+* @pkgdoc transport
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef TRANSPORT_H_1792237205
+#define TRANSPORT_H_1792237205
+/*----------------------------------------------------------------------------*/
+#include <string>
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include "lockfree_queue.h"
+/*----------------------------------------------------------------------------*/
+/**
+ * Event delivered from transport I/O thread to the transport owner.
+ */
+struct TransportEvent {
+  enum Type {
+    Received, //Data received from device
+    Written,  //Write request completed
+    Progress, //Write request in progress
+    Detached, //Device lost, waiting for arrival
+    Attached, //Device reopened after arrival
+    Recovery, //Error recovery step applied
+    Error     //Transfer error
+  };
+  Type type = Received;
+  int status = 0;
+  size_t length = 0; //Received bytes or bytes accepted by device
+  size_t total = 0;  //Write request size
+  double rate = 0;   //Write speed, bytes per second
+  double elapsed = 0; //Detach to ready time or write to receive latency, seconds
+  std::vector<uint8_t> data;
+  std::string message;
+};
+/*----------------------------------------------------------------------------*/
+/**
+ * Received data tap for script executor waiting for device answer.
+ * Shared by transport and its I/O thread, may be set while transport is opened.
+ */
+class ReceiveMonitor {
+  std::mutex mutex;
+  std::atomic<bool> active {false};
+  std::function<void(const std::vector<uint8_t>&)> callback;
+public:
+  /**Callback is not called after set() returns*/
+  void set(const std::function<void(const std::vector<uint8_t>&)>& f) {
+    std::lock_guard<std::mutex> lock(mutex);
+    callback = f;
+    active = static_cast<bool>(f);
+  }
+  //--------------------------------------
+  void received(const std::vector<uint8_t>& data) {
+    if(!active) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if(callback) {
+      callback(data);
+    }
+  }
+};
+/*----------------------------------------------------------------------------*/
+/**
+ * Events queue from I/O thread to owner.
+ * Notify function is called once per batch of events, until owner polls the queue.
+ * Received data is shown to monitor before it is queued.
+ */
+class TransportEventQueue {
+  LockFreeQueue<TransportEvent> events;
+  std::atomic<bool> notify_pending {false};
+  std::function<void()> notify;
+  std::shared_ptr<ReceiveMonitor> monitor;
+public:
+  void setNotify(const std::function<void()>& f) {notify = f;}
+  void setMonitor(const std::shared_ptr<ReceiveMonitor>& m) {monitor = m;}
+  //--------------------------------------
+  void post(TransportEvent&& event) {
+    if(event.type == TransportEvent::Received && monitor) {
+      monitor->received(event.data);
+    }
+    events.push(std::move(event));
+    if(!notify_pending.exchange(true) && notify) {
+      notify();
+    }
+  }
+  //--------------------------------------
+  bool pop(TransportEvent *event) {
+    notify_pending = false;
+    return events.pop(*event);
+  }
+};
+/*----------------------------------------------------------------------------*/
+/**
+ * Data block queued to transport without copy.
+ * Owner keeps memory (vector, mapped file) alive while transport uses the data.
+ */
+struct TransportBuffer {
+  const uint8_t *data = nullptr;
+  size_t size = 0;
+  std::shared_ptr<const void> owner;
+  //--------------------------------------
+  /**Buffer owning copy of data*/
+  static TransportBuffer copy(const void *src, size_t size) {
+    auto storage = std::make_shared<std::vector<uint8_t>>(static_cast<const uint8_t *>(src), static_cast<const uint8_t *>(src) + size);
+    TransportBuffer buffer;
+    buffer.data = storage->data();
+    buffer.size = size;
+    buffer.owner = storage;
+    return buffer;
+  }
+};
+/*----------------------------------------------------------------------------*/
+/**
+ * Transport interface.
+ * Writes are queued and never block the caller, results are collected via poll().
+ */
+class Transport {
+protected:
+  std::string m_message;
+  int m_error = 0;
+  std::function<void()> m_notify;
+  std::shared_ptr<ReceiveMonitor> m_monitor = std::make_shared<ReceiveMonitor>();
+public:
+  virtual ~Transport() {}
+
+  virtual void close() = 0;
+  virtual bool isOpened() const = 0;
+  /**Human readable connection description*/
+  virtual std::string name() const = 0;
+
+  /**Queue data to send. Returns queued size or -1 on error*/
+  virtual int write(const void *buffer, size_t size) = 0;
+  /**Queue data to send without copy. Returns queued size or -1 on error*/
+  virtual int writeBuffer(const TransportBuffer& buffer) {return write(buffer.data, buffer.size);}
+  /**Fetch next event from I/O thread. Returns false if queue is empty*/
+  virtual bool poll(TransportEvent *event) = 0;
+  /**Bytes queued by write() and not accepted by device yet*/
+  virtual size_t pendingBytes() const = 0;
+
+  /**Set function called from I/O thread when new events are available*/
+  void setNotify(const std::function<void()>& notify) {m_notify = notify;}
+  /**Set function called from I/O thread with received data. Can be changed at any time*/
+  void setReceiveMonitor(const std::function<void(const std::vector<uint8_t>&)>& f) {m_monitor->set(f);}
+  bool isError() const {return m_error != 0;}
+  const std::string& message() const {return m_message;}
+  int error() const {return m_error;}
+};
+/*----------------------------------------------------------------------------*/
+#endif /*TRANSPORT_H_1792237205*/
+
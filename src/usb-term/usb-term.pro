@@ -2,7 +2,7 @@ QT       += core gui
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
-CONFIG += c++11
+CONFIG += c++17
 
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
@@ -13,15 +13,30 @@ SOURCES += \
     text_highlighter.cpp \
     usb_ids.c \
     usbcon.cpp \
+    virtual_transport.cpp \
+    send_file.cpp \
+    script_cache.cpp \
+    headless.cpp \
+    poll_transport.cpp \
+    chardev_transport.cpp \
+    tcp_transport.cpp \
+    pty_transport.cpp \
     connectiondialog.cpp \
     hex_dump.cpp \
+    hex_view.cpp \
+    log_model.cpp \
+    capture_store.cpp \
     main.cpp \
     mainwindow.cpp \
     outputform.cpp \
-    text_parser.cpp
+    text_parser.cpp \
+    crc.cpp \
+    codepage.cpp
 
 HEADERS += \
     connectiondialog.h \
+    hex_view.h \
+    log_model.h \
     inputform.h \
     mainwindow.h \
     outputform.h \
@@ -18,8 +18,18 @@
 #include <libusb-1.0/libusb.h>
 #include <memory>
 #include <string>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <algorithm>
 //#include <stdexcept>
 #include "usb_ids.h"
+#include "lockfree_queue.h"
 /*----------------------------------------------------------------------------*/
 static void trace(const char *file, int line, const char *format, ...) {
   va_list ap;
@@ -48,137 +58,1457 @@ std::string string_format( const char *format, ... )
   return std::string( buf.get(), buf.get() + size - 1 ); // We don't want the '\0' inside
 }
 /*----------------------------------------------------------------------------*/
-class UsbConnectionPrivate {
+static int device_string_raw(libusb_device_handle *handle, uint8_t desc_index, uint16_t langid,
+                             unsigned char *data, int length, unsigned timeout) {
+  return libusb_control_transfer(handle, LIBUSB_ENDPOINT_IN, LIBUSB_REQUEST_GET_DESCRIPTOR,
+                                 (uint16_t) ((LIBUSB_DT_STRING << 8) | desc_index), langid,
+                                 data, (uint16_t) length, timeout);
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Read string descriptor as ASCII.
+ * Own timeout is used: libusb_get_string_descriptor_ascii() waits 1 s for each request.
+ */
+static int device_string_descriptor(libusb_device_handle *handle, uint8_t desc_index, uint16_t langid,
+                                    unsigned timeout, const char *name, std::string *dst) {
+  if (desc_index == 0) {
+    return 0;
+  }
+
+  unsigned char data[255];
+  int res = device_string_raw(handle, desc_index, langid, data, sizeof(data), timeout);
+  if (res < 0) {
+    trace(__FILE__, __LINE__, "Error get string descriptor for %s: %s\n", name, libusb_error_name(res));
+    return res;
+  }
+  if (res < 2 || data[1] != LIBUSB_DT_STRING) {
+    return 0;
+  }
+  if (res > data[0]) {
+    res = data[0];
+  }
+  dst->clear();
+  for (int i = 2; i + 1 < res; i += 2) {
+    dst->push_back((data[i + 1] || (data[i] & 0x80)) ? '?' : (char) data[i]);
+  }
+  return 0;
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Fill device identification without any I/O to the device.
+ * Returns key of string descriptors cache: port path and device descriptor checksum.
+ */
+static std::string device_id(libusb_device *dev, UsbDeviceInfo *dst) {
+  struct libusb_device_descriptor desc;
+  int r = libusb_get_device_descriptor(dev, &desc);
+  if (r < 0) {
+    trace(__FILE__, __LINE__, "Failed libusb_get_device_descriptor(): %d:%s\n", r, libusb_error_name(r));
+    return std::string();
+  }
+
+  dst->idVendor = desc.idVendor;
+  dst->idProduct = desc.idProduct;
+  dst->busNumber = libusb_get_bus_number(dev);
+  dst->deviceAddress = libusb_get_device_address(dev);
+
+  dst->portPath = std::to_string(dst->busNumber);
+  uint8_t ports[8];
+  r = libusb_get_port_numbers(dev, ports, sizeof(ports));
+  for (int i = 0; i < r; i++) {
+    dst->portPath += (i ? "." : "-") + std::to_string(ports[i]);
+  }
+
+  //FNV-1a
+  uint32_t hash = 2166136261u;
+  const uint8_t *p = (const uint8_t *) &desc;
+  for (size_t i = 0; i < sizeof(desc); i++) {
+    hash = (hash ^ p[i]) * 16777619u;
+  }
+  return dst->portPath + string_format(":%08X", hash);
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Read vendor, product and serial strings. Every request is limited by timeout,
+ * device which does not answer is not asked for other strings.
+ */
+static bool device_strings(libusb_device *dev, UsbDeviceInfo *dst, unsigned timeout) {
+  struct libusb_device_descriptor desc;
+  libusb_device_handle *handle = nullptr;
+  int r;
+
+  r = libusb_get_device_descriptor(dev, &desc);
+  if (r < 0) {
+    return false;
+  }
+
+  r = libusb_open(dev, &handle);
+  if (r < 0) {
+    trace(__FILE__, __LINE__, "Failed libusb_open(): %d:%s\n", r, libusb_error_name(r));
+    return false;
+  }
+
+  if (desc.iManufacturer || desc.iProduct || desc.iSerialNumber) {
+    unsigned char langs[4];
+    r = device_string_raw(handle, 0, 0, langs, sizeof(langs), timeout);
+    if (r >= 4) {
+      uint16_t langid = langs[2] | (langs[3] << 8);
+      if (device_string_descriptor(handle, desc.iManufacturer, langid, timeout, "Vendor", &dst->vendor) != LIBUSB_ERROR_TIMEOUT
+          && device_string_descriptor(handle, desc.iProduct, langid, timeout, "Product", &dst->product) != LIBUSB_ERROR_TIMEOUT) {
+        device_string_descriptor(handle, desc.iSerialNumber, langid, timeout, "Serial", &dst->serial);
+      }
+    } else if (r < 0) {
+      trace(__FILE__, __LINE__, "Error get language list: %s\n", libusb_error_name(r));
+    }
+  }
+  libusb_close(handle);
+
+  //Get vendor and product name from hardcoded DB
+  if(dst->vendor.empty() && dst->product.empty()) {
+    const char *str = usb_get_vendor_name(desc.idVendor);
+    if(str) {
+      dst->vendor = str;
+    }
+    str = usb_get_product_name(desc.idVendor, desc.idProduct);
+    if(str) {
+      dst->product = str;
+    }
+  }
+
+  return true;
+}
+/*----------------------------------------------------------------------------*/
+/**
+ * Object called by service event thread after each events handling pass.
+ */
+class UsbServiceClient {
 public:
+  virtual ~UsbServiceClient() {}
+  virtual void process() = 0;
+  /**Milliseconds until client needs process() call, -1 if not needed*/
+  virtual int timeout() const {return -1;}
+};
+/*----------------------------------------------------------------------------*/
+struct UsbDeviceEntry {
+  libusb_device *dev = nullptr;
+  UsbDeviceInfo info;
+  std::string key;      //Strings cache key
+  bool valid = false;   //String descriptors was read
+  bool pending = false; //Queued to info workers
+};
+/*----------------------------------------------------------------------------*/
+/**
+ * Process-wide libusb context, event thread and device cache.
+ * With hotplug support cache is updated incrementally by hotplug events,
+ * otherwise it is rebuilt on every request.
+ * String descriptors are read by worker threads, so one slow device does not
+ * delay others, and are kept by port path after device is unplugged.
+ */
+class UsbServicePrivate {
+public:
+  enum {
+    EVENT_TIMEOUT_MS = 100,
+    INFO_THREADS = 4,
+    STRING_TIMEOUT_MS = 250
+  };
+  libusb_context *ctx = nullptr;
+  libusb_hotplug_callback_handle callback_handle = 0;
+  bool hotplug = false;
+  std::thread thread;
+  std::atomic<bool> running {false};
+  LockFreeQueue<std::function<void()>> tasks;
+  std::mutex clients_mutex;
+  std::vector<UsbServiceClient *> clients;
+  std::mutex devices_mutex;
+  std::vector<UsbDeviceEntry> devices;
+  std::map<std::string, UsbDeviceInfo> info_cache; //By UsbDeviceEntry::key, under devices_mutex
+  std::map<int, UsbDeviceListener> listeners;      //Under devices_mutex
+  int last_listener = 0;
+  std::vector<std::thread> workers;
+  std::mutex info_mutex;
+  std::condition_variable info_cv;
+  std::deque<libusb_device *> info_queue;
+  bool workers_running = false;
+  std::vector<libusb_device *> arrived; //Filled by hotplug callback, event thread only
+  std::vector<libusb_device *> left;
+  //--------------------------------------
+  UsbServicePrivate() {
+    int r = libusb_init(&ctx);
+    if (r < 0) {
+      trace(__FILE__, __LINE__, "Failed to initialize libusb: %s\n", libusb_error_name(r));
+      ctx = nullptr;
+      return;
+    }
+    // Set verbose debugging output
+    libusb_set_option(ctx, LIBUSB_OPTION_LOG_LEVEL, /*__debug ? LIBUSB_LOG_LEVEL_DEBUG :*/ LIBUSB_LOG_LEVEL_INFO); // Keep DEBUG level
+
+    if(libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG)) {
+      r = libusb_hotplug_register_callback(ctx,
+                                           (libusb_hotplug_event) (LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT),
+                                           LIBUSB_HOTPLUG_ENUMERATE, // Fill cache with already connected devices
+                                           LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY,
+                                           &UsbServicePrivate::hotplugCallback, this, &callback_handle);
+      if (r < 0) {
+        trace(__FILE__, __LINE__, "Hotplug registration failed: %s\n", libusb_error_name(r));
+      } else {
+        hotplug = true;
+        processHotplug();
+      }
+    }
+
+    running = true;
+    thread = std::thread(&UsbServicePrivate::run, this);
+  }
+  //--------------------------------------
+  ~UsbServicePrivate() {
+    if(!ctx) {
+      return;
+    }
+    stopWorkers();
+    if(thread.joinable()) {
+      running = false;
+      libusb_interrupt_event_handler(ctx);
+      thread.join();
+    }
+    if(hotplug) {
+      libusb_hotplug_deregister_callback(ctx, callback_handle);
+    }
+    clearDevices();
+    for(auto dev : arrived) {
+      libusb_unref_device(dev);
+    }
+    for(auto dev : left) {
+      libusb_unref_device(dev);
+    }
+    libusb_exit(ctx);
+  }
+  //--------------------------------------
+  void run() {
+    while(running) {
+      int ms = clientsTimeout();
+      struct timeval tv = {ms / 1000, (ms % 1000) * 1000};
+      libusb_handle_events_timeout_completed(ctx, &tv, nullptr);
+      std::function<void()> task;
+      while(tasks.pop(task)) {
+        task();
+      }
+      processHotplug();
+      std::lock_guard<std::mutex> lock(clients_mutex);
+      for(auto client : clients) {
+        client->process();
+      }
+    }
+  }
+  //--------------------------------------
+  int clientsTimeout() {
+    int result = EVENT_TIMEOUT_MS;
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    for(auto client : clients) {
+      int ms = client->timeout();
+      if(ms >= 0 && ms < result) {
+        result = ms;
+      }
+    }
+    return result;
+  }
+  //--------------------------------------
+  /**
+   * Run function on event thread and wait for completion.
+   */
+  void invoke(const std::function<void()>& fn) {
+    if(!thread.joinable() || std::this_thread::get_id() == thread.get_id()) {
+      fn();
+      return;
+    }
+    std::promise<void> done;
+    std::future<void> result = done.get_future();
+    tasks.push([&fn, &done]() {
+      fn();
+      done.set_value();
+    });
+    wakeup();
+    result.wait();
+  }
+  //--------------------------------------
+  void wakeup() {
+    libusb_interrupt_event_handler(ctx);
+  }
+  //--------------------------------------
+  void addClient(UsbServiceClient *client) {
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    clients.push_back(client);
+  }
+  //--------------------------------------
+  void removeClient(UsbServiceClient *client) {
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    clients.erase(std::remove(clients.begin(), clients.end(), client), clients.end());
+  }
+  //--------------------------------------
+  static int LIBUSB_CALL hotplugCallback(libusb_context *ctx, libusb_device *dev, libusb_hotplug_event event, void *user_data) {
+    (void) ctx;
+    UsbServicePrivate *data = (UsbServicePrivate *) user_data;
+    //Device can not be opened inside callback: defer to processHotplug()
+    if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED) {
+      data->arrived.push_back(libusb_ref_device(dev));
+    } else if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT) {
+      data->left.push_back(libusb_ref_device(dev));
+    }
+    return 0;
+  }
+  //--------------------------------------
+  void processHotplug() {
+    for(auto dev : arrived) {
+      addDevice(dev);
+    }
+    arrived.clear();
+
+    for(auto dev : left) {
+      removeDevice(dev);
+      libusb_unref_device(dev);
+    }
+    left.clear();
+  }
+  //--------------------------------------
+  /**
+   * Add device to cache, referenced device is owned by cache.
+   * Strings are taken from info cache or requested from workers.
+   */
+  void addDevice(libusb_device *dev) {
+    UsbDeviceEntry entry;
+    entry.dev = dev;
+    entry.key = device_id(dev, &entry.info);
+    std::lock_guard<std::mutex> lock(devices_mutex);
+    auto it = entry.key.empty() ? info_cache.end() : info_cache.find(entry.key);
+    if(it != info_cache.end()) {
+      entry.info.vendor = it->second.vendor;
+      entry.info.product = it->second.product;
+      entry.info.serial = it->second.serial;
+      entry.valid = true;
+      notify(entry.info, true);
+    } else if(!entry.key.empty()) {
+      entry.pending = true;
+      queueInfo(dev);
+    }
+    devices.push_back(entry);
+  }
+  //--------------------------------------
+  void removeDevice(libusb_device *dev) {
+    std::lock_guard<std::mutex> lock(devices_mutex);
+    for(auto it = devices.begin(); it != devices.end(); ++it) {
+      if(it->dev == dev) {
+        if(it->valid) {
+          notify(it->info, false);
+        }
+        libusb_unref_device(it->dev);
+        devices.erase(it);
+        break;
+      }
+    }
+  }
+  //--------------------------------------
+  /**Call listeners, devices_mutex must be locked*/
+  void notify(const UsbDeviceInfo& info, bool present) {
+    for(auto& item : listeners) {
+      item.second(info, present);
+    }
+  }
+  //--------------------------------------
+  void queueInfo(libusb_device *dev) {
+    std::lock_guard<std::mutex> lock(info_mutex);
+    if(!workers_running) {
+      workers_running = true;
+      for(int i = 0; i < INFO_THREADS; i++) {
+        workers.emplace_back(&UsbServicePrivate::infoWorker, this);
+      }
+    }
+    info_queue.push_back(libusb_ref_device(dev));
+    info_cv.notify_one();
+  }
+  //--------------------------------------
+  void stopWorkers() {
+    {
+      std::lock_guard<std::mutex> lock(info_mutex);
+      workers_running = false;
+    }
+    info_cv.notify_all();
+    for(auto& worker : workers) {
+      worker.join();
+    }
+    workers.clear();
+    for(auto dev : info_queue) {
+      libusb_unref_device(dev);
+    }
+    info_queue.clear();
+  }
+  //--------------------------------------
+  void infoWorker() {
+    for(;;) {
+      libusb_device *dev = nullptr;
+      {
+        std::unique_lock<std::mutex> lock(info_mutex);
+        info_cv.wait(lock, [this]() {return !workers_running || !info_queue.empty();});
+        if(!workers_running) {
+          return;
+        }
+        dev = info_queue.front();
+        info_queue.pop_front();
+      }
+
+      UsbDeviceInfo info;
+      bool valid = device_strings(dev, &info, STRING_TIMEOUT_MS);
+
+      std::lock_guard<std::mutex> lock(devices_mutex);
+      for(auto& entry : devices) {
+        if(entry.dev == dev && entry.pending) {
+          entry.pending = false;
+          if(valid) {
+            entry.info.vendor = info.vendor;
+            entry.info.product = info.product;
+            entry.info.serial = info.serial;
+            entry.valid = true;
+            info_cache[entry.key] = entry.info;
+            notify(entry.info, true);
+          }
+          break;
+        }
+      }
+      libusb_unref_device(dev);
+    }
+  }
+  //--------------------------------------
+  void clearDevices() {
+    std::lock_guard<std::mutex> lock(devices_mutex);
+    for(auto& entry : devices) {
+      libusb_unref_device(entry.dev);
+    }
+    devices.clear();
+  }
+  //--------------------------------------
+  /**
+   * Update cache from device list. Used when platform has no hotplug support.
+   */
+  void rescan() {
+    libusb_device **devs = nullptr;
+    ssize_t cnt = libusb_get_device_list(ctx, &devs);
+    if (cnt < 0) {
+      trace(__FILE__, __LINE__, "Failed libusb_get_device_list(): %d:%s\n", (int) cnt, libusb_error_name(cnt));
+      return;
+    }
+
+    std::vector<libusb_device *> added;
+    std::vector<libusb_device *> removed;
+    {
+      std::lock_guard<std::mutex> lock(devices_mutex);
+      for (ssize_t i = 0; i < cnt; i++) {
+        auto it = std::find_if(devices.begin(), devices.end(), [&](const UsbDeviceEntry& entry) {return entry.dev == devs[i];});
+        if(it == devices.end()) {
+          added.push_back(libusb_ref_device(devs[i]));
+        }
+      }
+      for(auto& entry : devices) {
+        if(std::find(devs, devs + cnt, entry.dev) == devs + cnt) {
+          removed.push_back(entry.dev);
+        }
+      }
+    }
+    libusb_free_device_list(devs, 1);
+
+    for(auto dev : removed) {
+      removeDevice(dev);
+    }
+    for(auto dev : added) {
+      addDevice(dev);
+    }
+  }
+  //--------------------------------------
+  int addListener(const UsbDeviceListener& listener) {
+    if(!hotplug) {
+      rescan();
+    }
+    std::lock_guard<std::mutex> lock(devices_mutex);
+    int id = ++last_listener;
+    listeners[id] = listener;
+    for(const auto& entry : devices) {
+      if(entry.valid) {
+        listener(entry.info, true);
+      }
+    }
+    return id;
+  }
+  //--------------------------------------
+  void removeListener(int id) {
+    std::lock_guard<std::mutex> lock(devices_mutex);
+    listeners.erase(id);
+  }
+  //--------------------------------------
+  /**
+   * Find connected device by VID:PID. Returned device is referenced.
+   */
+  libusb_device *findDevice(uint16_t vendor_id, uint16_t product_id) {
+    if(!hotplug) {
+      rescan();
+    }
+    std::lock_guard<std::mutex> lock(devices_mutex);
+    for(auto& entry : devices) {
+      if(entry.info.idVendor == vendor_id && entry.info.idProduct == product_id) {
+        return libusb_ref_device(entry.dev);
+      }
+    }
+    return nullptr;
+  }
+};
+/*----------------------------------------------------------------------------*/
+UsbService :: UsbService()
+{
+  d = new UsbServicePrivate;
+}
+/*----------------------------------------------------------------------------*/
+UsbService :: ~UsbService()
+{
+  delete d;
+}
+/*----------------------------------------------------------------------------*/
+UsbService& UsbService :: instance()
+{
+  static UsbService service;
+  return service;
+}
+/*----------------------------------------------------------------------------*/
+bool UsbService :: isValid() const
+{
+  return d->ctx != nullptr;
+}
+/*----------------------------------------------------------------------------*/
+std::vector<UsbDeviceInfo> UsbService :: devices()
+{
+  std::vector<UsbDeviceInfo> result;
+  if(!isValid()) {
+    return result;
+  }
+  if(!d->hotplug) {
+    d->rescan();
+  }
+  std::lock_guard<std::mutex> lock(d->devices_mutex);
+  for(const auto& entry : d->devices) {
+    if(entry.valid) {
+      result.push_back(entry.info);
+    }
+  }
+  return result;
+}
+/*----------------------------------------------------------------------------*/
+int UsbService :: addListener(const UsbDeviceListener& listener)
+{
+  return isValid() ? d->addListener(listener) : 0;
+}
+/*----------------------------------------------------------------------------*/
+void UsbService :: removeListener(int id)
+{
+  if(isValid()) {
+    d->removeListener(id);
+  }
+}
+/*----------------------------------------------------------------------------*/
+class UsbConnectionPrivate;
+struct UsbReadTransfer {
+  UsbConnectionPrivate *owner = nullptr;
+  libusb_transfer *transfer = nullptr;
+  std::vector<uint8_t> buffer;
+  bool pending = false;
+};
+/**
+ * One write() request. Sent by chunks, several chunks may be in flight.
+ */
+struct UsbWriteJob {
+  TransportBuffer data;
+  size_t submitted = 0;  //Bytes handed to transfers
+  size_t accepted = 0;   //Bytes confirmed by device
+  int in_flight = 0;
+  bool zlp = false;      //Zero length packet required after last chunk
+  bool zlp_sent = false;
+  std::chrono::steady_clock::time_point started;
+  std::chrono::steady_clock::time_point reported;
+  //--------------------------------------
+  bool isSubmitted() const {
+    return submitted >= data.size && (!zlp || zlp_sent);
+  }
+  //--------------------------------------
+  double rate(std::chrono::steady_clock::time_point now) const {
+    double sec = std::chrono::duration<double>(now - started).count();
+    return sec > 0 ? accepted / sec : 0;
+  }
+};
+struct UsbWriteTransfer {
+  UsbConnectionPrivate *owner = nullptr;
+  libusb_transfer *transfer = nullptr;
+  UsbWriteJob *job = nullptr;
+  bool pending = false;
+};
+/*----------------------------------------------------------------------------*/
+class UsbConnectionPrivate : public UsbServiceClient {
+public:
+  enum {
+    DEFAULT_MAX_PACKET = 64,
+    PROGRESS_INTERVAL_MS = 100,
+    RETRY_COUNT = 3,            //Retries before device reset
+    RETRY_BACKOFF_MS = 10,      //First retry delay, doubled on each retry
+    RECOVERY_CONFIRM_MS = 1000, //Recovery is successful if no errors during this time
+    REOPEN_RETRY_COUNT = 10,    //Reopen retries while device is still attached
+    REOPEN_RETRY_MS = 500
+  };
+  //Error recovery ladder, from cheapest step to the most expensive one
+  enum RecoveryStep {
+    ClearHalt,
+    Retry,
+    Reset,
+    Reopen,
+    RecoveryStepCount
+  };
+  struct RecoveryStat {
+    int count = 0;     //Step applied
+    int success = 0;   //Step resolved error
+    double total_ms = 0; //Time spent in step
+  };
   uint16_t vendor_id = 0;
   uint16_t product_id = 0;
   libusb_context *ctx = nullptr;
   libusb_device_handle *dev_handle = nullptr;
   libusb_hotplug_callback_handle callback_handle = 0;
   bool kernel_driver_active = false;
-  bool must_reopen = false;
   int config_number = 0;
   int interface_number = 0;
   int altsettings_num = 0;
   uint8_t read_ep = 0;
   uint8_t write_ep = 0;
+  int read_max_packet = DEFAULT_MAX_PACKET;
+  int write_max_packet = DEFAULT_MAX_PACKET;
   std::string message;
+  //Hotplug state
+  enum State {
+    Ready,      //Device opened, transfers are running
+    Detaching,  //Device lost, waiting for transfers completion
+    Detached,   //Device closed, waiting for arrival
+    Recovering, //Transfer error, waiting for transfers completion
+    Backoff,    //Waiting before retry
+    Reopening   //Device is attached but can not be opened, waiting before next reopen
+  };
+  State state = Ready;
+  libusb_device *arrived_dev = nullptr;
+  std::chrono::steady_clock::time_point detached_at;
+  int reconnect_count = 0;
+  double reconnect_total_ms = 0;
+  double reconnect_max_ms = 0;
+  std::vector<uint8_t> attach_script;
+  //Error recovery state
+  int recovery_step = -1;  //Last applied step or -1
+  int recovery_retries = 0;
+  int reopen_retries = 0;
+  int recovery_status = 0; //Transfer status caused recovery
+  uint8_t recovery_ep = 0;
+  std::chrono::steady_clock::time_point recovery_started;
+  std::chrono::steady_clock::time_point recovery_resumed;
+  std::chrono::steady_clock::time_point retry_at;
+  RecoveryStat recovery_stats[RecoveryStepCount];
+  //I/O thread data
+  UsbServicePrivate *service = nullptr;
+  bool started = false;
+  std::atomic<bool> running {false};
+  TransportEventQueue events;                   //I/O thread -> owner
+  int read_queue_depth = UsbSettings::DEFAULT_READ_QUEUE_DEPTH;
+  int read_packets = UsbSettings::DEFAULT_READ_PACKETS;
+  std::vector<UsbReadTransfer> read_transfers;
+  std::atomic<int> reads_pending {0};
+  int write_queue_depth = UsbSettings::DEFAULT_WRITE_QUEUE_DEPTH;
+  int write_chunk_size = UsbSettings::DEFAULT_WRITE_CHUNK_SIZE;
+  bool write_zlp = true;
+  std::vector<UsbWriteTransfer> write_transfers;
+  std::vector<UsbWriteTransfer *> free_writes;
+  std::atomic<int> writes_pending {0};
+  std::deque<UsbWriteJob *> jobs;
+  std::atomic<size_t> queued_bytes {0};         //Bytes written but not accepted by device yet
+  LockFreeQueue<TransportBuffer> requests; //Owner -> I/O thread
+  std::mutex drain_mutex;                  //Completion of transfers -> stop()
+  std::condition_variable drain_cv;
+  //--------------------------------------
+  ~UsbConnectionPrivate() { close();}
+  //--------------------------------------
+  /**
+   * Hotplug callback and process() use device handle on service event thread:
+   * device is closed there, after callback is deregistered.
+   */
+  void close() {
+    stop();
+    if(!service) {
+      return;
+    }
+    service->invoke([this]() {
+      if(ctx) {
+        libusb_hotplug_deregister_callback(ctx, callback_handle);
+        closeDevice();
+        ctx = nullptr;
+      }
+      if(arrived_dev) {
+        libusb_unref_device(arrived_dev);
+        arrived_dev = nullptr;
+      }
+    });
+  }
+  //--------------------------------------
+  void closeDevice() {
+    if(dev_handle) {
+      libusb_release_interface(dev_handle, interface_number);
+      if(kernel_driver_active) {
+        libusb_attach_kernel_driver(dev_handle, interface_number); // Reattach if we detached
+      }
+      libusb_close(dev_handle);
+      dev_handle = nullptr;
+    }
+  }
+  //--------------------------------------
+  bool findEndpoints() {
+    struct libusb_config_descriptor *config;
+    int config_index = 0, interface_index, altsettings_index;
+
+    read_ep = 0;
+    write_ep = 0;
+    read_max_packet = DEFAULT_MAX_PACKET;
+    write_max_packet = DEFAULT_MAX_PACKET;
+    libusb_get_config_descriptor(libusb_get_device(dev_handle), config_index, &config);
+    if (!config) {
+      trace(__FILE__, __LINE__, "Could not get config #%d descriptor.\n", config_number);
+      message = string_format("Could not get config #%d descriptor.\n", config_number);
+      return false;
+    }
+
+    config_number = config->bConfigurationValue;
+    // Iterate through interfaces and their altsettings to find endpoints
+    for (interface_index = 0; interface_index < config->bNumInterfaces; interface_index ++) {
+      const struct libusb_interface *inter = &config->interface[interface_index];
+      for (altsettings_index = 0; altsettings_index < inter->num_altsetting; altsettings_index ++) {
+        const struct libusb_interface_descriptor *inter_desc = &inter->altsetting[altsettings_index];
+        interface_number = inter_desc->bInterfaceNumber;
+        altsettings_num = inter_desc->bAlternateSetting;
+
+        // Check if this is the Printer class interface you care about (class 7)
+        // Or if it's Vendor Specific (class 255)
+        if (
+            ((inter_desc->bInterfaceClass == LIBUSB_CLASS_PRINTER && (inter_desc->bInterfaceProtocol == 1 || inter_desc->bInterfaceProtocol == 2)) || // Unidirectional or Bidirectional Printer
+             (inter_desc->bInterfaceClass == LIBUSB_CLASS_VENDOR_SPEC && inter_desc->bAlternateSetting == 2))) { // Vendor Specific for AltSetting 2
+
+          unsigned char endpoint_in = 0, endpoint_out = 0;
+          int packet_in = 0, packet_out = 0;
+          //out_endpoint_address = find_endpoint(dev_handle, LIBUSB_ENDPOINT_OUT);
+          //in_endpoint_address = find_endpoint(dev_handle, LIBUSB_ENDPOINT_IN);
+
+          for (int k = 0; k < inter_desc->bNumEndpoints; k++) {
+            const struct libusb_endpoint_descriptor *ep_desc = &inter_desc->endpoint[k];
+
+            if ((ep_desc->bEndpointAddress & LIBUSB_ENDPOINT_DIR_MASK) == LIBUSB_ENDPOINT_IN
+                && (ep_desc->bmAttributes & LIBUSB_TRANSFER_TYPE_MASK) == LIBUSB_TRANSFER_TYPE_BULK) { // Look for Bulk endpoints
+              endpoint_in = ep_desc->bEndpointAddress;
+              packet_in = ep_desc->wMaxPacketSize & 0x7ff;
+            }
+
+            if ((ep_desc->bEndpointAddress & LIBUSB_ENDPOINT_DIR_MASK) == LIBUSB_ENDPOINT_OUT
+                && (ep_desc->bmAttributes & LIBUSB_TRANSFER_TYPE_MASK) == LIBUSB_TRANSFER_TYPE_BULK) { // Look for Bulk endpoints
+              endpoint_out = ep_desc->bEndpointAddress;
+              packet_out = ep_desc->wMaxPacketSize & 0x7ff;
+            }
+            if(endpoint_in != 0 && endpoint_out != 0) {
+              read_ep = endpoint_in;
+              write_ep = endpoint_out;
+              if(packet_in > 0) {
+                read_max_packet = packet_in;
+              }
+              if(packet_out > 0) {
+                write_max_packet = packet_out;
+              }
+              break;
+            }
+          }
+        }
+        if(read_ep && write_ep) {
+          break;
+        }
+      }
+      if(read_ep && write_ep) {
+        break;
+      }
+    }
+
+    libusb_free_config_descriptor(config);
+    return read_ep != 0 && write_ep != 0;
+  }
+  //--------------------------------------
+  static int LIBUSB_CALL hotplugCallback(libusb_context *ctx, libusb_device *dev,libusb_hotplug_event event, void *user_data) {
+    struct libusb_device_descriptor desc;
+    UsbConnectionPrivate *data;
+
+    (void) ctx;
+    data = (UsbConnectionPrivate *) user_data;
+    if(data == NULL) {
+      trace(__FILE__, __LINE__, "Invalid usb driver data\n");
+      return 0;
+    }
+
+    int rc = libusb_get_device_descriptor(dev, &desc);
+    if (rc < 0) {
+      trace(__FILE__, __LINE__, "Error getting device descriptor\n");
+      return 0;
+    }
+
+    //Called on service event thread: device is reopened later by process()
+    if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED) {
+      trace(__FILE__, __LINE__, "Device attached: %04x:%04x\n", desc.idVendor, desc.idProduct);
+      if(data->arrived_dev) {
+        libusb_unref_device(data->arrived_dev);
+      }
+      data->arrived_dev = libusb_ref_device(dev);
+    } else if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT) {
+      trace(__FILE__, __LINE__,  "Device detached: %04x:%04x\n", desc.idVendor, desc.idProduct);
+      if(data->dev_handle && libusb_get_device(data->dev_handle) == dev) {
+        data->beginDetach();
+      }
+    }
+    return 0;
+  }
+  //--------------------------------------
+  void cancelTransfers() {
+    for(auto& r : read_transfers) {
+      if(r.pending) {
+        libusb_cancel_transfer(r.transfer);
+      }
+    }
+    for(auto& w : write_transfers) {
+      if(w.pending) {
+        libusb_cancel_transfer(w.transfer);
+      }
+    }
+  }
+  //--------------------------------------
+  /**
+   * Rewind unfinished jobs to the last byte accepted by device.
+   */
+  void rewindJobs() {
+    for(auto job : jobs) {
+      job->submitted = job->accepted;
+      job->zlp_sent = false;
+    }
+  }
+  //--------------------------------------
+  /**
+   * Open device and prepare it. On error device is closed and message is set.
+   */
+  int openDevice(libusb_device *dev) {
+    int r = libusb_open(dev, &dev_handle);
+    if (r < 0) {
+      trace(__FILE__, __LINE__, "Failed libusb_open(): %d:%s\n", r, libusb_error_name(r));
+      dev_handle = nullptr;
+      message = string_format("Failed to reopen device: %s", libusb_error_name(r));
+      return r;
+    }
+    message.clear();
+    r = claim();
+    if(r != 0) {
+      closeDevice();
+    }
+    return r;
+  }
+  //--------------------------------------
+  /**
+   * Device lost: cancel transfers, keep write queue for resume.
+   */
+  void beginDetach() {
+    if(state == Detaching || state == Detached) {
+      return;
+    }
+    state = Detaching;
+    detached_at = std::chrono::steady_clock::now();
+    recovery_step = -1;
+    recovery_retries = 0;
+    reopen_retries = 0;
+    cancelTransfers();
+  }
+  //--------------------------------------
+  /**
+   * All transfers are completed: close device and wait for arrival.
+   */
+  void finishDetach() {
+    closeDevice();
+    rewindJobs();
+    state = Detached;
+
+    TransportEvent event;
+    event.type = TransportEvent::Detached;
+    event.message = string_format("Device detached: VID=0x%04X, PID=0x%04X", vendor_id, product_id);
+    postEvent(std::move(event));
+  }
+  //--------------------------------------
+  /**
+   * Reopen arrived device, restart reads, queue attach script before restarted writes.
+   */
+  void reattach(libusb_device *dev) {
+    int r = openDevice(dev);
+    if(r != 0) {
+      TransportEvent event;
+      event.type = TransportEvent::Error;
+      event.status = r;
+      event.message = message;
+      postEvent(std::move(event));
+      return;
+    }
+
+    state = Ready;
+    submitReads();
+    restartJobs();
+    queueAttachScript();
+    auto now = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(now - detached_at).count();
+    reconnect_count ++;
+    reconnect_total_ms += ms;
+    if(ms > reconnect_max_ms) {
+      reconnect_max_ms = ms;
+    }
+
+    TransportEvent event;
+    event.type = TransportEvent::Attached;
+    event.elapsed = ms / 1000.0;
+    event.message = string_format("Device ready in %.1f ms (reconnects: %d, average: %.1f ms, max: %.1f ms)",
+                                  ms, reconnect_count, reconnect_total_ms / reconnect_count, reconnect_max_ms);
+    postEvent(std::move(event));
+  }
+  //--------------------------------------
+  static const char *recoveryStepName(int step) {
+    switch(step) {
+      case ClearHalt: return "clear halt";
+      case Retry: return "retry";
+      case Reset: return "reset";
+      case Reopen: return "reopen";
+      default: return "none";
+    }
+  }
+  //--------------------------------------
+  std::string recoveryStats() const {
+    std::string result;
+    for(int i = 0; i < RecoveryStepCount; i++) {
+      const RecoveryStat& st = recovery_stats[i];
+      result += string_format("%s%s: %d/%d %.1f ms", i ? ", " : "", recoveryStepName(i), st.success, st.count,
+                              st.count ? st.total_ms / st.count : 0.0);
+    }
+    return result;
+  }
+  //--------------------------------------
+  void postRecovery(const std::string& text) {
+    TransportEvent event;
+    event.type = TransportEvent::Recovery;
+    event.status = recovery_status;
+    event.message = text + " [" + recoveryStats() + "]";
+    postEvent(std::move(event));
+  }
+  //--------------------------------------
+  /**
+   * Transfer error: stop all transfers and apply next recovery step when they are completed.
+   */
+  void beginRecovery(uint8_t ep, int status) {
+    if(state != Ready) {
+      return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if(recovery_step < 0) {
+      recovery_started = now;
+      reopen_retries = 0;
+    }
+    recovery_ep = ep;
+    recovery_status = status;
+    state = Recovering;
+    cancelTransfers();
+  }
+  //--------------------------------------
+  int nextRecoveryStep() const {
+    if(recovery_step < ClearHalt && recovery_status == LIBUSB_TRANSFER_STALL) {
+      return ClearHalt;
+    }
+    if(recovery_step <= Retry && recovery_retries < RETRY_COUNT) {
+      return Retry;
+    }
+    if(recovery_step < Reset) {
+      return Reset;
+    }
+    if(recovery_step < Reopen) {
+      return Reopen;
+    }
+    return -1;
+  }
+  //--------------------------------------
+  /**
+   * Apply recovery steps until one of them succeeds.
+   */
+  void applyRecovery() {
+    rewindJobs();
+    for(;;) {
+      int step = nextRecoveryStep();
+      if(step < 0) {
+        //Nothing more to try: wait for device arrival
+        closeDevice();
+        state = Detached;
+        detached_at = recovery_started;
+        recovery_step = -1;
+        recovery_retries = 0;
+        postRecovery(string_format("Recovery failed, endpoint 0x%02X, waiting for device", recovery_ep));
+        return;
+      }
+
+      auto started = std::chrono::steady_clock::now();
+      int r = 0;
+      int delay = 0;
+      recovery_step = step;
+      switch(step) {
+        case ClearHalt:
+          r = libusb_clear_halt(dev_handle, recovery_ep);
+          break;
+        case Retry:
+          delay = RETRY_BACKOFF_MS << recovery_retries;
+          recovery_retries ++;
+          break;
+        case Reset:
+          //LIBUSB_ERROR_NOT_FOUND: device re-enumerated, handle is not valid anymore
+          r = libusb_reset_device(dev_handle);
+          break;
+        case Reopen: {
+          closeDevice();
+          libusb_device *dev = service->findDevice(vendor_id, product_id);
+          r = dev ? openDevice(dev) : LIBUSB_ERROR_NO_DEVICE;
+          if(dev) {
+            libusb_unref_device(dev);
+          }
+          break;
+        }
+      }
+      auto now = std::chrono::steady_clock::now();
+      RecoveryStat& st = recovery_stats[step];
+      st.count ++;
+      st.total_ms += std::chrono::duration<double, std::milli>(now - started).count();
+
+      if(step == Reopen && r != 0 && r != LIBUSB_ERROR_NO_DEVICE && reopen_retries < REOPEN_RETRY_COUNT) {
+        //Hotplug arrival will not come for device that is still attached: retry by timer
+        reopen_retries ++;
+        state = Reopening;
+        retry_at = now + std::chrono::milliseconds(REOPEN_RETRY_MS);
+        postRecovery(string_format("Recovery reopen failed: %s, retry %d of %d in %d ms", libusb_error_name(r),
+                                   reopen_retries, static_cast<int>(REOPEN_RETRY_COUNT), static_cast<int>(REOPEN_RETRY_MS)));
+        return;
+      }
+      if(r != 0) {
+        trace(__FILE__, __LINE__, "Recovery step %s failed: %s\n", recoveryStepName(step), libusb_error_name(r));
+        postRecovery(string_format("Recovery %s failed: %s", recoveryStepName(step), libusb_error_name(r)));
+        continue;
+      }
+
+      postRecovery(string_format("Recovery %s, endpoint 0x%02X, transfer status %d", recoveryStepName(step), recovery_ep, recovery_status));
+      if(delay > 0) {
+        state = Backoff;
+        retry_at = now + std::chrono::milliseconds(delay);
+      } else {
+        resume();
+      }
+      return;
+    }
+  }
+  //--------------------------------------
+  void resume() {
+    state = Ready;
+    recovery_resumed = std::chrono::steady_clock::now();
+    submitReads();
+  }
+  //--------------------------------------
+  /**
+   * No errors after last recovery step: count it as successful.
+   */
+  void confirmRecovery() {
+    recovery_stats[recovery_step].success ++;
+    double ms = std::chrono::duration<double, std::milli>(recovery_resumed - recovery_started).count();
+    postRecovery(string_format("Recovered by %s in %.1f ms", recoveryStepName(recovery_step), ms));
+    recovery_step = -1;
+    recovery_retries = 0;
+  }
+  //--------------------------------------
+  int timeout() const override {
+    auto now = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point at;
+    if(state == Backoff || state == Reopening) {
+      at = retry_at;
+    } else if(state == Ready && recovery_step >= 0) {
+      at = recovery_resumed + std::chrono::milliseconds(RECOVERY_CONFIRM_MS);
+    } else {
+      return -1;
+    }
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(at - now).count();
+    return ms > 0 ? static_cast<int>(ms) : 0;
+  }
+  //--------------------------------------
+  /**
+   * Device has lost the state of interrupted job with re-enumeration:
+   * the job is sent again from start, with or without attach script.
+   */
+  void restartJobs() {
+    for(auto queued : jobs) {
+      queued_bytes += queued->accepted;
+      queued->accepted = 0;
+      queued->submitted = 0;
+      queued->zlp_sent = false;
+    }
+  }
+  //--------------------------------------
+  /**
+   * Attach script goes before all queued jobs.
+   */
+  void queueAttachScript() {
+    if(attach_script.empty()) {
+      return;
+    }
+    UsbWriteJob *job = new UsbWriteJob;
+    job->data = TransportBuffer::copy(attach_script.data(), attach_script.size());
+    job->zlp = write_zlp && job->data.size % write_max_packet == 0;
+    queued_bytes += job->data.size;
+    jobs.push_front(job);
+  }
+  //--------------------------------------
+  void process() override {
+    if(!running) {
+      return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    bool drained = reads_pending == 0 && writes_pending == 0;
+    if(state == Detaching && drained) {
+      finishDetach();
+    }
+    if(state == Recovering && drained) {
+      applyRecovery();
+    }
+    if(state == Backoff && now >= retry_at) {
+      resume();
+    }
+    if(state == Reopening && now >= retry_at) {
+      recovery_step = Reset;
+      applyRecovery();
+    }
+    if(state == Ready && recovery_step >= 0 && now - recovery_resumed >= std::chrono::milliseconds(RECOVERY_CONFIRM_MS)) {
+      confirmRecovery();
+    }
+    //Arrival while detach or recovery is in progress is kept until they end:
+    //recovery may fail with no device and wait for arrival that has come already
+    if(arrived_dev && (state == Detached || state == Ready)) {
+      libusb_device *dev = arrived_dev;
+      arrived_dev = nullptr;
+      if(state == Detached) {
+        reattach(dev);
+      }
+      libusb_unref_device(dev);
+    }
+    pumpWrites();
+  }
+  //--------------------------------------
+  void postEvent(TransportEvent&& event) {
+    events.post(std::move(event));
+  }
+  //--------------------------------------
+  void postError(int r, const char *what) {
+    TransportEvent event;
+    event.type = TransportEvent::Error;
+    event.status = r;
+    event.message = string_format("%s: %s", what, libusb_error_name(r));
+    postEvent(std::move(event));
+  }
+  //--------------------------------------
+  bool submitRead(UsbReadTransfer *r) {
+    libusb_fill_bulk_transfer(r->transfer, dev_handle, read_ep, r->buffer.data(), r->buffer.size(), &UsbConnectionPrivate::readCallback, r, 0);
+    int rc = libusb_submit_transfer(r->transfer);
+    if(rc < 0) {
+      trace(__FILE__, __LINE__, "Failed to submit read: %s\n", libusb_error_name(rc));
+      if(rc == LIBUSB_ERROR_NO_DEVICE) {
+        beginDetach();
+      } else {
+        postError(rc, "Failed to read data");
+        beginRecovery(read_ep, LIBUSB_TRANSFER_ERROR);
+      }
+      return false;
+    }
+    r->pending = true;
+    reads_pending ++;
+    return true;
+  }
   //--------------------------------------
-  ~UsbConnectionPrivate() { close();}
+  /**
+   * Transfer is not used anymore: counted down last, stop() may free it at once.
+   */
+  void transferDone(std::atomic<int>& pending) {
+    std::lock_guard<std::mutex> lock(drain_mutex);
+    pending --;
+    drain_cv.notify_all();
+  }
   //--------------------------------------
-  void close() {
-    if(ctx) {
-      if(dev_handle) {
-        libusb_release_interface(dev_handle, interface_number);
-        if(kernel_driver_active) {
-          libusb_attach_kernel_driver(dev_handle, interface_number); // Reattach if we detached
+  static void LIBUSB_CALL readCallback(libusb_transfer *transfer) {
+    UsbReadTransfer *r = (UsbReadTransfer *) transfer->user_data;
+    UsbConnectionPrivate *data = r->owner;
+    data->readCompleted(r, transfer);
+    data->transferDone(data->reads_pending);
+  }
+  //--------------------------------------
+  void readCompleted(UsbReadTransfer *r, libusb_transfer *transfer) {
+    r->pending = false;
+    switch(transfer->status) {
+      case LIBUSB_TRANSFER_COMPLETED:
+        if(transfer->actual_length > 0) {
+          TransportEvent event;
+          event.type = TransportEvent::Received;
+          event.length = transfer->actual_length;
+          event.data.assign(transfer->buffer, transfer->buffer + transfer->actual_length);
+          postEvent(std::move(event));
         }
-        libusb_close(dev_handle);
-        dev_handle = nullptr;
+        break;
+      case LIBUSB_TRANSFER_TIMED_OUT:
+        break;
+      case LIBUSB_TRANSFER_CANCELLED:
+        return;
+      case LIBUSB_TRANSFER_NO_DEVICE:
+        trace(__FILE__, __LINE__, "Printer disconnected or reset! Waiting for device...\n");
+        beginDetach();
+        return;
+      default:
+        trace(__FILE__, __LINE__, "Failed to read data: transfer status %d\n", transfer->status);
+        beginRecovery(read_ep, transfer->status);
+        return;
+    }
+    //Resubmit at once: the other transfers of the ring keep the endpoint busy meanwhile
+    if(running && state == Ready) {
+      submitRead(r);
+    }
+  }
+  //--------------------------------------
+  /**
+   * Allocate and submit ring of read transfers.
+   * Each buffer is multiple of endpoint wMaxPacketSize to avoid overflow errors.
+   */
+  void startReads() {
+    int depth = read_queue_depth > 0 ? read_queue_depth : 1;
+    int packets = read_packets > 0 ? read_packets : 1;
+    read_transfers.resize(depth);
+    for(auto& r : read_transfers) {
+      r.owner = this;
+      r.transfer = libusb_alloc_transfer(0);
+      r.buffer.resize(static_cast<size_t>(read_max_packet) * packets);
+    }
+    submitReads();
+  }
+  //--------------------------------------
+  void submitReads() {
+    for(auto& r : read_transfers) {
+      if(!submitRead(&r)) {
+        break;
       }
-
-      libusb_hotplug_deregister_callback(ctx, callback_handle);
-      libusb_exit(ctx);
-      ctx = nullptr;
     }
   }
   //--------------------------------------
-  bool findEndpoints() {
-    struct libusb_config_descriptor *config;
-    int config_index = 0, interface_index, altsettings_index;
-
-    read_ep = 0;
-    write_ep = 0;
-    libusb_get_config_descriptor(libusb_get_device(dev_handle), config_index, &config);
-    if (!config) {
-      trace(__FILE__, __LINE__, "Could not get config #%d descriptor.\n", config_number);
-      message = string_format("Could not get config #%d descriptor.\n", config_number);
-      return false;
+  /**
+   * Allocate pool of write transfers.
+   * Chunk is multiple of endpoint wMaxPacketSize, so only the last chunk of job may be short.
+   */
+  void startWrites() {
+    int depth = write_queue_depth > 0 ? write_queue_depth : 1;
+    write_transfers.resize(depth);
+    free_writes.clear();
+    for(auto& w : write_transfers) {
+      w.owner = this;
+      w.transfer = libusb_alloc_transfer(0);
+      free_writes.push_back(&w);
+    }
+    int packets = write_chunk_size / write_max_packet;
+    write_chunk_size = (packets > 0 ? packets : 1) * write_max_packet;
+  }
+  //--------------------------------------
+  UsbWriteJob *nextJob() {
+    for(auto job : jobs) {
+      if(!job->isSubmitted()) {
+        return job;
+      }
+    }
+    return nullptr;
+  }
+  //--------------------------------------
+  /**
+   * Take new requests and keep up to write_queue_depth chunks in flight.
+   * Transfers have no timeout: slow device holds back the queue by NAK, but the job is not aborted.
+   */
+  void pumpWrites() {
+    TransportBuffer buffer;
+    while(requests.pop(buffer)) {
+      UsbWriteJob *job = new UsbWriteJob;
+      job->data = std::move(buffer);
+      job->zlp = write_zlp && job->data.size % write_max_packet == 0;
+      jobs.push_back(job);
     }
 
-    config_number = config->bConfigurationValue;
-    // Iterate through interfaces and their altsettings to find endpoints
-    for (interface_index = 0; interface_index < config->bNumInterfaces; interface_index ++) {
-      const struct libusb_interface *inter = &config->interface[interface_index];
-      for (altsettings_index = 0; altsettings_index < inter->num_altsetting; altsettings_index ++) {
-        const struct libusb_interface_descriptor *inter_desc = &inter->altsetting[altsettings_index];
-        interface_number = inter_desc->bInterfaceNumber;
-        altsettings_num = inter_desc->bAlternateSetting;
-
-        // Check if this is the Printer class interface you care about (class 7)
-        // Or if it's Vendor Specific (class 255)
-        if (
-            ((inter_desc->bInterfaceClass == LIBUSB_CLASS_PRINTER && (inter_desc->bInterfaceProtocol == 1 || inter_desc->bInterfaceProtocol == 2)) || // Unidirectional or Bidirectional Printer
-             (inter_desc->bInterfaceClass == LIBUSB_CLASS_VENDOR_SPEC && inter_desc->bAlternateSetting == 2))) { // Vendor Specific for AltSetting 2
-
-          unsigned char endpoint_in = 0, endpoint_out = 0;
-          //out_endpoint_address = find_endpoint(dev_handle, LIBUSB_ENDPOINT_OUT);
-          //in_endpoint_address = find_endpoint(dev_handle, LIBUSB_ENDPOINT_IN);
-
-          for (int k = 0; k < inter_desc->bNumEndpoints; k++) {
-            const struct libusb_endpoint_descriptor *ep_desc = &inter_desc->endpoint[k];
-
-            if ((ep_desc->bEndpointAddress & LIBUSB_ENDPOINT_DIR_MASK) == LIBUSB_ENDPOINT_IN
-                && (ep_desc->bmAttributes & LIBUSB_TRANSFER_TYPE_MASK) == LIBUSB_TRANSFER_TYPE_BULK) { // Look for Bulk endpoints
-              endpoint_in = ep_desc->bEndpointAddress;
-            }
-
-            if ((ep_desc->bEndpointAddress & LIBUSB_ENDPOINT_DIR_MASK) == LIBUSB_ENDPOINT_OUT
-                && (ep_desc->bmAttributes & LIBUSB_TRANSFER_TYPE_MASK) == LIBUSB_TRANSFER_TYPE_BULK) { // Look for Bulk endpoints
-              endpoint_out = ep_desc->bEndpointAddress;
-            }
-            if(endpoint_in != 0 && endpoint_out != 0) {
-              read_ep = endpoint_in;
-              write_ep = endpoint_out;
-              break;
-            }
-          }
-        }
-        if(read_ep && write_ep) {
-          break;
+    while(running && state == Ready && !free_writes.empty()) {
+      UsbWriteJob *job = nextJob();
+      if(!job) {
+        break;
+      }
+      size_t len = job->data.size - job->submitted;
+      if(len > static_cast<size_t>(write_chunk_size)) {
+        len = write_chunk_size;
+      }
+      UsbWriteTransfer *w = free_writes.back();
+      w->job = job;
+      //OUT transfer does not modify the buffer: mapped read only pages may be passed as is
+      libusb_fill_bulk_transfer(w->transfer, dev_handle, write_ep, const_cast<uint8_t *>(job->data.data) + job->submitted, len, &UsbConnectionPrivate::writeCallback, w, 0);
+      int r = libusb_submit_transfer(w->transfer);
+      if(r < 0) {
+        trace(__FILE__, __LINE__, "Failed to write data: %s, size:%lu\n", libusb_error_name(r), len);
+        if(r == LIBUSB_ERROR_NO_DEVICE) {
+          beginDetach();
+        } else {
+          beginRecovery(write_ep, LIBUSB_TRANSFER_ERROR);
         }
+        break;
       }
-      if(read_ep && write_ep) {
+      if(job->accepted == 0 && job->in_flight == 0) {
+        job->started = job->reported = std::chrono::steady_clock::now();
+      }
+      free_writes.pop_back();
+      w->pending = true;
+      writes_pending ++;
+      job->in_flight ++;
+      job->submitted += len;
+      if(len == 0) {
+        job->zlp_sent = true;
+      }
+    }
+    finishJobs();
+  }
+  //--------------------------------------
+  /**
+   * Report progress of the current job and remove finished jobs from queue head.
+   */
+  void finishJobs() {
+    auto now = std::chrono::steady_clock::now();
+    while(!jobs.empty()) {
+      UsbWriteJob *job = jobs.front();
+      if(job->in_flight > 0 || !job->isSubmitted()) {
+        if(job->accepted > 0 && now - job->reported >= std::chrono::milliseconds(PROGRESS_INTERVAL_MS)) {
+          job->reported = now;
+          TransportEvent event;
+          event.type = TransportEvent::Progress;
+          event.length = job->accepted;
+          event.total = job->data.size;
+          event.rate = job->rate(now);
+          postEvent(std::move(event));
+        }
         break;
       }
+      queued_bytes -= job->data.size - job->accepted;
+      TransportEvent event;
+      event.type = TransportEvent::Written;
+      event.length = job->accepted;
+      event.total = job->data.size;
+      event.rate = job->rate(now);
+      postEvent(std::move(event));
+      jobs.pop_front();
+      delete job;
     }
-
-    libusb_free_config_descriptor(config);
-    return read_ep != 0 && write_ep != 0;
   }
   //--------------------------------------
-  static int LIBUSB_CALL hotplugCallback(libusb_context *ctx, libusb_device *dev,libusb_hotplug_event event, void *user_data) {
-    struct libusb_device_descriptor desc;
-    UsbConnectionPrivate *data;
+  static void LIBUSB_CALL writeCallback(libusb_transfer *transfer) {
+    UsbWriteTransfer *w = (UsbWriteTransfer *) transfer->user_data;
+    UsbConnectionPrivate *data = w->owner;
+    data->writeCompleted(w, transfer);
+    data->transferDone(data->writes_pending);
+  }
+  //--------------------------------------
+  void writeCompleted(UsbWriteTransfer *w, libusb_transfer *transfer) {
+    UsbWriteJob *job = w->job;
 
-    (void) ctx;
-    data = (UsbConnectionPrivate *) user_data;
-    if(data == NULL) {
-      trace(__FILE__, __LINE__, "Invalid usb driver data\n");
-    }
+    w->pending = false;
+    w->job = nullptr;
+    free_writes.push_back(w);
+    job->in_flight --;
+    job->accepted += transfer->actual_length;
+    queued_bytes -= transfer->actual_length;
 
-    int rc = libusb_get_device_descriptor(dev, &desc);
-    if (rc < 0) {
-      trace(__FILE__, __LINE__, "Error getting device descriptor\n");
-      return 0;
+    switch(transfer->status) {
+      case LIBUSB_TRANSFER_COMPLETED:
+        break;
+      case LIBUSB_TRANSFER_CANCELLED:
+        //Cancelled by stop, detach or recovery: job is resumed later
+        break;
+      case LIBUSB_TRANSFER_NO_DEVICE:
+        trace(__FILE__, __LINE__, "Printer disconnected or reset! Waiting for device...\n");
+        beginDetach();
+        break;
+      default:
+        trace(__FILE__, __LINE__, "Failed to write data: transfer status %d, size:%d\n", transfer->status, transfer->length);
+        beginRecovery(write_ep, transfer->status);
+        break;
     }
-
-    if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED) {
-      trace(__FILE__, __LINE__, "Device attached: %04x:%04x\n", desc.idVendor, desc.idProduct);
-      // Тут потрібно спробувати знову відкрити пристрій та налаштувати його
-      if(data != NULL) {
-        data->must_reopen = true;
+    pumpWrites();
+  }
+  //--------------------------------------
+  //--------------------------------------
+  void start() {
+    service->invoke([this]() {
+      running = true;
+      startReads();
+      startWrites();
+      queueAttachScript();
+    });
+    service->addClient(this);
+    started = true;
+  }
+  //--------------------------------------
+  void stop() {
+    if(!started) {
+      return;
+    }
+    started = false;
+    service->removeClient(this);
+    //Cancel all active transfers and wait for completion
+    service->invoke([this]() {
+      running = false;
+      for(auto& r : read_transfers) {
+        if(r.pending) {
+          libusb_cancel_transfer(r.transfer);
+        }
       }
-    } else if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT) {
-      trace(__FILE__, __LINE__,  "Device detached: %04x:%04x\n", desc.idVendor, desc.idProduct);
-      // Тут потрібно очистити всі існуючі хендли та позначити пристрій як недоступний
-      if(data != NULL) {
-        data->must_reopen = true;
+      for(auto& w : write_transfers) {
+        if(w.pending) {
+          libusb_cancel_transfer(w.transfer);
+        }
       }
+    });
+    {
+      std::unique_lock<std::mutex> lock(drain_mutex);
+      drain_cv.wait(lock, [this]() {return reads_pending == 0 && writes_pending == 0;});
     }
-    return 0;
-  }
 
+    for(auto& r : read_transfers) {
+      libusb_free_transfer(r.transfer);
+    }
+    read_transfers.clear();
+    for(auto& w : write_transfers) {
+      libusb_free_transfer(w.transfer);
+    }
+    write_transfers.clear();
+    free_writes.clear();
+    for(auto job : jobs) {
+      delete job;
+    }
+    jobs.clear();
+  }
+  //--------------------------------------
+  void queueWrite(const TransportBuffer& buffer) {
+    queued_bytes += buffer.size;
+    requests.push(buffer);
+    service->wakeup();
+  }
+  //--------------------------------------
   static int open(uint16_t vendor_id, uint16_t product_id, UsbConnectionPrivate *dst)
   {
     int r = 0;
@@ -186,85 +1516,102 @@ public:
     dst->vendor_id = vendor_id;
     dst->product_id = product_id;
 
-    r = libusb_init(&dst->ctx);
-    if (r < 0) {
-      trace(__FILE__, __LINE__, "Failed to initialize libusb: %s\n", libusb_error_name(r));
-      return r;
+    dst->service = UsbService::instance().d;
+    dst->ctx = dst->service->ctx;
+    if (!dst->ctx) {
+      dst->message = "Failed to initialize libusb";
+      return -1;
     }
-    // Set verbose debugging output
-    libusb_set_option(dst->ctx, LIBUSB_OPTION_LOG_LEVEL, /*__debug ? LIBUSB_LOG_LEVEL_DEBUG :*/ LIBUSB_LOG_LEVEL_INFO); // Keep DEBUG level
 
-    // Find the device
-    dst->dev_handle = libusb_open_device_with_vid_pid(dst->ctx, vendor_id, product_id);
+    // Find the device in service cache
+    libusb_device *dev = dst->service->findDevice(vendor_id, product_id);
+    if (dev) {
+      r = libusb_open(dev, &dst->dev_handle);
+      libusb_unref_device(dev);
+      if (r < 0) {
+        trace(__FILE__, __LINE__, "Failed libusb_open(): %d:%s\n", r, libusb_error_name(r));
+        dst->dev_handle = nullptr;
+      }
+    } else {
+      dst->dev_handle = libusb_open_device_with_vid_pid(dst->ctx, vendor_id, product_id);
+    }
     if (!dst->dev_handle) {
       trace(__FILE__, __LINE__, "Open device error: VID=0x%04X, PID=0x%04X\n", vendor_id, product_id);
       dst->message = string_format("Open device error: VID=0x%04X, PID=0x%04X", vendor_id, product_id);
       return -1;
     }
 
+    r = libusb_hotplug_register_callback(dst->ctx,
+                                         (libusb_hotplug_event) (LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT),
+                                         LIBUSB_HOTPLUG_NO_FLAGS, // Device is already opened: only later events are interesting
+                                         vendor_id, product_id, LIBUSB_HOTPLUG_MATCH_ANY,
+                                         &UsbConnectionPrivate::hotplugCallback, dst, &dst->callback_handle);
+    if (r < 0) {
+      trace(__FILE__, __LINE__, "Hotplug registration failed: %s\n", libusb_error_name(r));
+      dst->message = string_format("Hotplug registration failed: %s", libusb_error_name(r));
+    } else {
+      r = dst->claim();
+    }
+    if(r != 0) {
+      dst->close();
+    }
+    return r;
+  }
+  //--------------------------------------
+  /**
+   * Prepare opened device: detach kernel driver, find endpoints, claim interface.
+   */
+  int claim()
+  {
+    int r = 0;
     do {
-      r = libusb_hotplug_register_callback(dst->ctx,
-                                           (libusb_hotplug_event) (LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT),
-                                           LIBUSB_HOTPLUG_ENUMERATE, // Також викликати для вже підключених пристроїв
-                                           vendor_id, product_id, LIBUSB_HOTPLUG_MATCH_ANY,
-                                           &UsbConnectionPrivate::hotplugCallback, dst, &dst->callback_handle);
-      if (r < 0) {
-        trace(__FILE__, __LINE__, "Hotplug registration failed: %s\n", libusb_error_name(r));
-        dst->message = string_format("Hotplug registration failed: %s", libusb_error_name(r));
-        break;
-      }
-      dst->must_reopen = false;
-
       // Check if a kernel driver is active and detach it
-      dst->kernel_driver_active = libusb_kernel_driver_active(dst->dev_handle, dst->interface_number); // Interface 0
-      if (dst->kernel_driver_active) {
+      kernel_driver_active = libusb_kernel_driver_active(dev_handle, interface_number); // Interface 0
+      if (kernel_driver_active) {
         trace(__FILE__, __LINE__, "Kernel driver active, detaching...\n");
-        r = libusb_detach_kernel_driver(dst->dev_handle, 0); // Detach interface 0
+        r = libusb_detach_kernel_driver(dev_handle, 0); // Detach interface 0
         if (r < 0) {
           trace(__FILE__, __LINE__, "Failed to detach kernel driver: %s\n", libusb_error_name(r));
-          dst->message = string_format("Failed to detach kernel driver: %s", libusb_error_name(r));
+          message = string_format("Failed to detach kernel driver: %s", libusb_error_name(r));
           break;
         }
       }
 
-      r = dst->findEndpoints() ? 0 : -1;
+      r = findEndpoints() ? 0 : -1;
       if(r != 0) {
         trace(__FILE__, __LINE__, "Failed to find endpoints\n");
-        if(dst->message.empty()) {
-          dst->message = "Failed to find endpoints";
+        if(message.empty()) {
+          message = "Failed to find endpoints";
         } else {
-          dst->message = std::string("Failed to find endpoints:") + dst->message;
+          message = std::string("Failed to find endpoints:") + message;
         }
         break;
       }
 
-      trace(__FILE__, __LINE__, "Opening: configuration:%d interface:%d alterSettings:%d\n", dst->config_number, dst->interface_number, dst->altsettings_num);
+      trace(__FILE__, __LINE__, "Opening: configuration:%d interface:%d alterSettings:%d\n", config_number, interface_number, altsettings_num);
       // Set configuration
-      r = libusb_set_configuration(dst->dev_handle, dst->config_number); // Configuration 1 (usually the first one)
+      r = libusb_set_configuration(dev_handle, config_number); // Configuration 1 (usually the first one)
       if (r < 0) {
-        trace(__FILE__, __LINE__, "Failed to set configuration #%d: %s\n", dst->config_number, libusb_error_name(r));
-        dst->message = string_format("Failed to set configuration #%d: %s", dst->config_number, libusb_error_name(r));
+        trace(__FILE__, __LINE__, "Failed to set configuration #%d: %s\n", config_number, libusb_error_name(r));
+        message = string_format("Failed to set configuration #%d: %s", config_number, libusb_error_name(r));
         break;
       }
 
       // Claim interface
-      r = libusb_claim_interface(dst->dev_handle, dst->interface_number); // Claim interface 0
+      r = libusb_claim_interface(dev_handle, interface_number); // Claim interface 0
       if (r < 0) {
-        trace(__FILE__, __LINE__, "Failed to claim interface #%d: %s\n", dst->interface_number, libusb_error_name(r));
-        dst->message = string_format("Failed to claim interface #%d: %s", dst->interface_number, libusb_error_name(r));
+        trace(__FILE__, __LINE__, "Failed to claim interface #%d: %s\n", interface_number, libusb_error_name(r));
+        message = string_format("Failed to claim interface #%d: %s", interface_number, libusb_error_name(r));
         break;
       }
 
       //Try setting Alternate Setting
-      r = libusb_set_interface_alt_setting(dst->dev_handle, dst->interface_number, dst->altsettings_num);
+      r = libusb_set_interface_alt_setting(dev_handle, interface_number, altsettings_num);
       if (r != 0) {
-        trace(__FILE__, __LINE__, "Failed to set interface alternate setting to %d: %s\n", dst->altsettings_num, libusb_error_name(r));
-        dst->message = string_format("Failed to set interface alternate setting to %d: %s", dst->altsettings_num, libusb_error_name(r));
+        trace(__FILE__, __LINE__, "Failed to set interface alternate setting to %d: %s\n", altsettings_num, libusb_error_name(r));
+        message = string_format("Failed to set interface alternate setting to %d: %s", altsettings_num, libusb_error_name(r));
       }
     } while(0);
-    if(r != 0) {
-      dst->close();
-    }
     return r;
   }
 
@@ -273,24 +1620,30 @@ public:
 bool UsbConnection :: open(uint16_t vendor_id, uint16_t product_id) {
   close();
   con = new UsbConnectionPrivate;
+  con->events.setNotify(m_notify);
+  con->events.setMonitor(m_monitor);
+  con->read_queue_depth = m_settings.readQueueDepth;
+  con->read_packets = m_settings.readPackets;
+  con->write_queue_depth = m_settings.writeQueueDepth;
+  con->write_chunk_size = m_settings.writeChunkSize;
+  con->write_zlp = m_settings.zeroLengthPacket;
+  con->attach_script = m_attachScript;
   m_message.clear();
   m_error = UsbConnectionPrivate :: open(vendor_id, product_id, con);
   if(isError()) {
     m_message = con->message;
     delete con;
     con = nullptr;
+  } else {
+    con->start();
   }
   return isOpened();
 }
 /*----------------------------------------------------------------------------*/
-bool UsbConnection :: reopen()
+bool UsbConnection :: checkOpened()
 {
   if(con) {
-    if(!con->must_reopen) {
-      return true;
-    }
-    con->close();
-    return open(con->vendor_id, con->product_id);
+    return true;
   }
   m_error = -1;
   m_message = "Not opened";
@@ -304,160 +1657,58 @@ void UsbConnection :: close() {
   }
 }
 /*----------------------------------------------------------------------------*/
-int UsbConnection :: read(void *buffer, size_t size, uint32_t ms)
+bool UsbConnection :: poll(TransportEvent *event)
 {
-  if(!reopen()) {
-    return -1;
+  if(!checkOpened()) {
+    return false;
   }
 
-  m_message.clear();
-  m_error = 0;
-  int actual_length = 0;
-  int r = libusb_bulk_transfer(con->dev_handle, con->read_ep, static_cast<unsigned char *>(buffer), size, &actual_length, ms);
-  if (r < 0) {
-    if(r == LIBUSB_ERROR_TIMEOUT) {
-      r = 0;
-    } else {
-      if (r == LIBUSB_ERROR_NO_DEVICE) {
-        trace(__FILE__, __LINE__, "Printer disconnected or reset! Re-establishing connection...\n");
-        con->must_reopen = 1;
-      } else {
-        trace(__FILE__, __LINE__, "Failed to read data: %s, timeout:%u\n", libusb_error_name(r), ms);
-        m_error = r;
-        m_message = libusb_error_name(r);
-      }
-    }
-  } else {
-    r = actual_length;
+  return con->events.pop(event);
+}
+/*----------------------------------------------------------------------------*/
+std::string UsbConnection :: name() const
+{
+  if(!con) {
+    return "USB";
   }
-  return r;
+  return string_format("USB %04X:%04X", con->vendor_id, con->product_id);
+}
+/*----------------------------------------------------------------------------*/
+size_t UsbConnection :: pendingBytes() const
+{
+  return con ? con->queued_bytes.load() : 0;
 }
 /*----------------------------------------------------------------------------*/
 int UsbConnection :: write(const void *buffer, size_t size)
 {
-  if(!reopen()) {
+  if(!checkOpened()) {
     return -1;
   }
 
   m_message.clear();
   m_error = 0;
-  int r = libusb_bulk_transfer(con->dev_handle, con->write_ep, static_cast<unsigned char*>(const_cast<void*>(buffer)), size, nullptr, 1000); // 5000ms timeout for reading
-  if (r < 0) {
-    if (r == LIBUSB_ERROR_NO_DEVICE) {
-      trace(__FILE__, __LINE__, "Printer disconnected or reset! Re-establishing connection...\n");
-      con->must_reopen = true;
-    } else {
-      trace(__FILE__, __LINE__, "Failed to write data: %s, size:%lu\n", libusb_error_name(r), size);
-      con->must_reopen = true; //!!!!!!!!!!
-    }
-    m_error = r;
-    m_message = libusb_error_name(r);
-  } else {
-    r = size;
-    //trace_hex(__FILE__, __LINE__, ">>", buffer, size);
-  }
-  return r;
-}
-/*----------------------------------------------------------------------------*/
-static std::string device_string_descriptor(libusb_device_handle *handle, uint8_t desc_index, const char *name) {
-  std::string result;
-  if (desc_index == 0) {
-    return result;
+  if(size > 0) {
+    con->queueWrite(TransportBuffer::copy(buffer, size));
   }
-
-  unsigned char str[256];
-  int res = libusb_get_string_descriptor_ascii(handle, desc_index, str, sizeof(str));
-  if (res > 0) {
-    result = (const char *)str;
-  } else {
-    trace(__FILE__, __LINE__, "Error libusb_get_string_descriptor_ascii() for %s: %s\n", name, libusb_error_name(res));
-  }
-  return result;
+  return size;
 }
 /*----------------------------------------------------------------------------*/
-static bool device_info(libusb_device *dev, UsbDeviceInfo *dst) {
-  struct libusb_device_descriptor desc;
-  libusb_device_handle *handle = nullptr;
-  int r;
-
-  r = libusb_get_device_descriptor(dev, &desc);
-  if (r < 0) {
-    trace(__FILE__, __LINE__, "Failed libusb_get_device_descriptor(): %d:%s\n", r, libusb_error_name(r));
-    return false;
-  }
-
-  dst->idVendor = desc.idVendor;
-  dst->idProduct = desc.idProduct;
-  dst->busNumber = libusb_get_bus_number(dev);
-  dst->deviceAddress = libusb_get_device_address(dev);
-
-  r = libusb_open(dev, &handle);
-  if (r < 0) {
-    trace(__FILE__, __LINE__, "Failed libusb_open(): %d:%s\n", r, libusb_error_name(r));
-  }
-
-
-  if (handle) {
-    dst->vendor = device_string_descriptor(handle, desc.iManufacturer, "Vendor");
-    dst->product = device_string_descriptor(handle, desc.iProduct, "Product");
-    dst->serial = device_string_descriptor(handle, desc.iSerialNumber, "Serial");
-
-    libusb_close(handle);
-  } else {
-    return false;
+int UsbConnection :: writeBuffer(const TransportBuffer& buffer)
+{
+  if(!checkOpened()) {
+    return -1;
   }
 
-  //Get vendor and product name from hardcoded DB
-  if(dst->vendor.empty() && dst->product.empty()) {
-    const char *str = usb_get_vendor_name(desc.idVendor);
-    if(str) {
-      dst->vendor = str;
-    }
-    str = usb_get_product_name(desc.idVendor, desc.idProduct);
-    if(str) {
-      dst->product = str;
-    }
+  m_message.clear();
+  m_error = 0;
+  if(buffer.size > 0) {
+    con->queueWrite(buffer);
   }
-
-  return true;
+  return buffer.size;
 }
 /*----------------------------------------------------------------------------*/
 std::vector<UsbDeviceInfo> usbDeviceList()
 {
-  libusb_device **devs = nullptr;
-  libusb_context *ctx = nullptr;
-  int r;
-  ssize_t cnt;
-  std::vector<UsbDeviceInfo> result;
-
-  do {
-    r = libusb_init(&ctx);
-    if (r < 0) {
-      trace(__FILE__, __LINE__, "Failed libusb_init(): %d:%s\n", r, libusb_error_name(r));
-      break;
-    }
-
-    cnt = libusb_get_device_list(ctx, &devs);
-    if (cnt < 0) {
-      trace(__FILE__, __LINE__, "Failed libusb_init(): %d:%s\n", cnt, libusb_error_name(cnt));
-      break;
-    }
-
-    for (ssize_t i = 0; i < cnt; i++) {
-      UsbDeviceInfo info;
-      if(device_info(devs[i], &info)) {
-        result.push_back(info);
-      }
-
-    }
-  } while(0);
-  if(devs) {
-    libusb_free_device_list(devs, 1);
-  }
-  if(ctx) {
-    libusb_exit(ctx);
-  }
-
-  return result;
+  return UsbService::instance().devices();
 }
 /*----------------------------------------------------------------------------*/
@@ -17,38 +17,94 @@
 /*----------------------------------------------------------------------------*/
 #include <string>
 #include <vector>
+#include <functional>
 #include <stdint.h>
+#include "transport.h"
 /*----------------------------------------------------------------------------*/
 struct UsbDeviceInfo {
   uint16_t idVendor = 0;
   uint16_t idProduct = 0;
   int busNumber = 0;
   int deviceAddress = 0;
+  std::string portPath; //Bus and port numbers: 1-2.4
   std::string vendor;
   std::string product;
   std::string serial;
 };
 std::vector<UsbDeviceInfo> usbDeviceList();
+/**Device list change listener: device with read descriptors is present or gone*/
+typedef std::function<void(const UsbDeviceInfo& info, bool present)> UsbDeviceListener;
+
+class UsbServicePrivate;
+/**
+ * Process-wide libusb context shared by all connections.
+ * Owns USB event thread and cached list of connected devices.
+ */
+class UsbService {
+  UsbServicePrivate *d = nullptr;
+  UsbService();
+  ~UsbService();
+  UsbService(const UsbService&) = delete;
+  UsbService& operator=(const UsbService&) = delete;
+  friend class UsbConnectionPrivate;
+public:
+  static UsbService& instance();
+  bool isValid() const;
+  /**Cached list of connected devices*/
+  std::vector<UsbDeviceInfo> devices();
+  /**
+   * Call listener for every known device and then on every change.
+   * Listener is called from service threads. Returns listener id.
+   */
+  int addListener(const UsbDeviceListener& listener);
+  void removeListener(int id);
+};
+
+/**Transfer pipeline of USB connection, applied on open*/
+struct UsbSettings {
+  enum {
+    DEFAULT_READ_QUEUE_DEPTH = 4, //Read transfers kept submitted on bulk IN endpoint
+    DEFAULT_READ_PACKETS = 32,    //Read transfer size in wMaxPacketSize units
+    DEFAULT_WRITE_QUEUE_DEPTH = 4, //Write chunks kept in flight
+    DEFAULT_WRITE_CHUNK_SIZE = 16384
+  };
+  int readQueueDepth = DEFAULT_READ_QUEUE_DEPTH;
+  int readPackets = DEFAULT_READ_PACKETS;
+  int writeQueueDepth = DEFAULT_WRITE_QUEUE_DEPTH;
+  int writeChunkSize = DEFAULT_WRITE_CHUNK_SIZE;
+  bool zeroLengthPacket = true; //Terminate writes of wMaxPacketSize multiple length by zero length packet
+};
 
 class UsbConnectionPrivate;
-class UsbConnection {
+/**
+ * USB connection over libusb asynchronous API.
+ * Transfers are handled by UsbService event thread, so read and write
+ * run at the same time and never block the caller.
+ * Results are collected via poll() in the owner thread.
+ */
+class UsbConnection : public Transport {
 protected:
   UsbConnectionPrivate *con = nullptr;
-  std::string m_message;
-  int m_error = 0;
-  bool reopen();
+  UsbSettings m_settings;
+  std::vector<uint8_t> m_attachScript;
+  bool checkOpened();
 public:
   bool open(uint16_t vendor_id, uint16_t product_id);
-  void close();
+  void close() override;
   ~UsbConnection() {close();}
 
-  int read(void *buffer, size_t buffer_size, uint32_t timeout_ms);
-  int write(const void *buffer, size_t size);
+  int write(const void *buffer, size_t size) override;
+  int writeBuffer(const TransportBuffer& buffer) override;
+  bool poll(TransportEvent *event) override;
+  size_t pendingBytes() const override;
+  bool isOpened() const override {return con != nullptr;}
+  std::string name() const override;
 
-  bool isOpened() const {return con != nullptr;}
-  bool isError() const {return m_error != 0;}
-  const std::string& message() const {return m_message;}
-  int error() const {return m_error;}
+  /**Read and write pipeline, applied on next open*/
+  void setSettings(const UsbSettings& settings) {m_settings = settings;}
+  const UsbSettings& settings() const {return m_settings;}
+  /**Data sent first after every device open, before restarted writes*/
+  void setAttachScript(const std::vector<uint8_t>& data) {m_attachScript = data;}
 };
 /*----------------------------------------------------------------------------*/
 #endif /*USBCON_H_1761289625*/
@@ -0,0 +1,263 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg virtual_transport
+*/
+/**
+* In-memory virtual device for testing and benchmarking without hardware.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 11:52:30<br>
+* @pkgdoc virtual_transport
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#include "virtual_transport.h"
+#include <stdio.h>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+/*----------------------------------------------------------------------------*/
+typedef std::chrono::steady_clock Clock;
+/*----------------------------------------------------------------------------*/
+struct VirtualJob {
+  TransportBuffer data;
+  size_t accepted = 0;
+  Clock::time_point written;  //write() call time
+  Clock::time_point started;  //First byte accepted
+  Clock::time_point reported;
+};
+/*----------------------------------------------------------------------------*/
+struct VirtualEcho {
+  Clock::time_point due;
+  Clock::time_point written;
+  std::vector<uint8_t> data;
+};
+/*----------------------------------------------------------------------------*/
+class VirtualTransportPrivate {
+public:
+  enum {
+    CHUNK_SIZE = 16384,
+    PROGRESS_INTERVAL_MS = 100,
+    MAX_ECHO = 4 * 1024 * 1024 //Echo not delivered yet, device stops accepting data above it
+  };
+  VirtualDeviceSettings settings;
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool running = false;
+  std::deque<VirtualJob> jobs;
+  std::deque<VirtualEcho> echoes;
+  size_t echo_bytes = 0;
+  Clock::time_point sink_free; //Time when device is ready for next chunk
+  std::atomic<size_t> queued_bytes {0};
+  TransportEventQueue events;
+  //--------------------------------------
+  void start() {
+    running = true;
+    sink_free = Clock::now();
+    thread = std::thread(&VirtualTransportPrivate::run, this);
+  }
+  //--------------------------------------
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      running = false;
+    }
+    cv.notify_one();
+    if(thread.joinable()) {
+      thread.join();
+    }
+  }
+  //--------------------------------------
+  void write(const TransportBuffer& buffer) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      VirtualJob job;
+      job.data = buffer;
+      job.written = Clock::now();
+      jobs.push_back(std::move(job));
+      queued_bytes += buffer.size;
+    }
+    cv.notify_one();
+  }
+  //--------------------------------------
+  double rate(const VirtualJob& job, Clock::time_point now) const {
+    double sec = std::chrono::duration<double>(now - job.started).count();
+    return sec > 0 ? job.accepted / sec : 0;
+  }
+  //--------------------------------------
+  bool canAccept(Clock::time_point now) const {
+    return !jobs.empty() && now >= sink_free && echo_bytes < MAX_ECHO;
+  }
+  //--------------------------------------
+  /**
+   * Accept next chunk of the current job if device sink is free.
+   */
+  void accept(Clock::time_point now) {
+    if(!canAccept(now)) {
+      return;
+    }
+    VirtualJob& job = jobs.front();
+    if(job.accepted == 0) {
+      job.started = job.reported = now;
+    }
+    size_t n = job.data.size - job.accepted;
+    if(n > CHUNK_SIZE) {
+      n = CHUNK_SIZE;
+    }
+    if(settings.echo) {
+      VirtualEcho echo;
+      echo.due = now + std::chrono::microseconds(static_cast<int64_t>(settings.latencyMs * 1000));
+      echo.written = job.written;
+      echo.data.assign(job.data.data + job.accepted, job.data.data + job.accepted + n);
+      echoes.push_back(std::move(echo));
+      echo_bytes += n;
+    }
+    job.accepted += n;
+    queued_bytes -= n;
+    if(settings.sinkRate > 0) {
+      sink_free = now + std::chrono::microseconds(static_cast<int64_t>(n * 1e6 / settings.sinkRate));
+    }
+
+    TransportEvent event;
+    if(job.accepted >= job.data.size) {
+      event.type = TransportEvent::Written;
+      event.length = job.accepted;
+      event.total = job.data.size;
+      event.rate = rate(job, now);
+      events.post(std::move(event));
+      jobs.pop_front();
+    } else if(now - job.reported >= std::chrono::milliseconds(PROGRESS_INTERVAL_MS)) {
+      job.reported = now;
+      event.type = TransportEvent::Progress;
+      event.length = job.accepted;
+      event.total = job.data.size;
+      event.rate = rate(job, now);
+      events.post(std::move(event));
+    }
+  }
+  //--------------------------------------
+  void deliver(Clock::time_point now) {
+    while(!echoes.empty() && echoes.front().due <= now) {
+      VirtualEcho& echo = echoes.front();
+      TransportEvent event;
+      event.type = TransportEvent::Received;
+      event.length = echo.data.size();
+      event.elapsed = std::chrono::duration<double>(now - echo.written).count();
+      echo_bytes -= echo.data.size();
+      event.data = std::move(echo.data);
+      events.post(std::move(event));
+      echoes.pop_front();
+    }
+  }
+  //--------------------------------------
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while(running) {
+      auto now = Clock::now();
+      accept(now);
+      deliver(now);
+
+      if(canAccept(now)) {
+        //Unlimited rate: let writers in between chunks
+        lock.unlock();
+        std::this_thread::yield();
+        lock.lock();
+        continue;
+      }
+      //Sleep until next chunk may be accepted or next echo is due
+      Clock::time_point wake = Clock::time_point::max();
+      if(!jobs.empty() && sink_free > now) {
+        wake = sink_free;
+      }
+      if(!echoes.empty() && echoes.front().due < wake) {
+        wake = echoes.front().due;
+      }
+      if(wake != Clock::time_point::max()) {
+        cv.wait_until(lock, wake);
+      } else {
+        cv.wait(lock);
+      }
+    }
+  }
+};
+/*----------------------------------------------------------------------------*/
+bool VirtualTransport :: open(const VirtualDeviceSettings& settings)
+{
+  close();
+  m_settings = settings;
+  m_message.clear();
+  m_error = 0;
+  d = new VirtualTransportPrivate;
+  d->settings = settings;
+  d->events.setNotify(m_notify);
+  d->events.setMonitor(m_monitor);
+  d->start();
+  return true;
+}
+/*----------------------------------------------------------------------------*/
+void VirtualTransport :: close()
+{
+  if(d) {
+    d->stop();
+    delete d;
+    d = nullptr;
+  }
+}
+/*----------------------------------------------------------------------------*/
+int VirtualTransport :: write(const void *buffer, size_t size)
+{
+  if(!d) {
+    m_error = -1;
+    m_message = "Not opened";
+    return -1;
+  }
+  m_message.clear();
+  m_error = 0;
+  if(size > 0) {
+    d->write(TransportBuffer::copy(buffer, size));
+  }
+  return size;
+}
+/*----------------------------------------------------------------------------*/
+int VirtualTransport :: writeBuffer(const TransportBuffer& buffer)
+{
+  if(!d) {
+    m_error = -1;
+    m_message = "Not opened";
+    return -1;
+  }
+  m_message.clear();
+  m_error = 0;
+  if(buffer.size > 0) {
+    d->write(buffer);
+  }
+  return buffer.size;
+}
+/*----------------------------------------------------------------------------*/
+bool VirtualTransport :: poll(TransportEvent *event)
+{
+  return d ? d->events.pop(event) : false;
+}
+/*----------------------------------------------------------------------------*/
+size_t VirtualTransport :: pendingBytes() const
+{
+  return d ? d->queued_bytes.load() : 0;
+}
+/*----------------------------------------------------------------------------*/
+std::string VirtualTransport :: name() const
+{
+  char rate[32] = "unlimited";
+  if(m_settings.sinkRate > 0) {
+    snprintf(rate, sizeof(rate), "%.0f KB/s", m_settings.sinkRate / 1000.0);
+  }
+  char buffer[128];
+  snprintf(buffer, sizeof(buffer), "Virtual device (%s, %s, %.3f ms)",
+           m_settings.echo ? "echo" : "sink", rate, m_settings.latencyMs);
+  return buffer;
+}
+/*----------------------------------------------------------------------------*/
+
@@ -0,0 +1,51 @@
+/*----------------------------------------------------------------------------*/
+/**
+* @pkg virtual_transport
+*/
+/**
+* In-memory virtual device for testing and benchmarking without hardware.
+*
+* (C) T&T, Kiev, Ukraine 2026.<br>
+* started 17.10.2026 11:52:30<br>
+* @pkgdoc virtual_transport
+* @author oleg
+* @version 0.01
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef VIRTUAL_TRANSPORT_H_1792237950
+#define VIRTUAL_TRANSPORT_H_1792237950
+/*----------------------------------------------------------------------------*/
+#include "transport.h"
+/*----------------------------------------------------------------------------*/
+struct VirtualDeviceSettings {
+  bool echo = true;      //Send written data back
+  double sinkRate = 0;   //Bytes per second accepted by device, 0 - unlimited
+  double latencyMs = 0;  //Device response time
+};
+
+class VirtualTransportPrivate;
+/**
+ * Virtual device running in own thread.
+ * Accepts written data with configured rate and optionally echoes it back
+ * after configured latency. Received events carry write to receive latency.
+ * Device stops accepting data while too much echo waits for latency.
+ */
+class VirtualTransport : public Transport {
+protected:
+  VirtualTransportPrivate *d = nullptr;
+  VirtualDeviceSettings m_settings;
+public:
+  bool open(const VirtualDeviceSettings& settings);
+  void close() override;
+  ~VirtualTransport() {close();}
+
+  int write(const void *buffer, size_t size) override;
+  int writeBuffer(const TransportBuffer& buffer) override;
+  bool poll(TransportEvent *event) override;
+  size_t pendingBytes() const override;
+  bool isOpened() const override {return d != nullptr;}
+  std::string name() const override;
+};
+/*----------------------------------------------------------------------------*/
+#endif /*VIRTUAL_TRANSPORT_H_1792237950*/
+